@@ -0,0 +1,202 @@
+/**
+\file BroadPhase.cpp
+\brief BroadPhase.cpp implements the all pairs disc-disc overlap search.
+*/
+#include <DiscCollide/BroadPhase.h>
+#include <DiscCollide/SegmentKernel.h>
+
+#include <algorithm>
+#include <math.h>
+
+using namespace std;
+using namespace ITCS4120::DiscCollide;
+
+/*******************************************************************************
+    File Scope Functions
+*******************************************************************************/
+namespace
+{
+/**
+\brief 'overlap' tells whether discs 'a' and 'b' of 'discs' overlap or touch.
+*/
+inline bool overlap (const DiscSet& discs, int a, int b)
+    {
+    const float dx=discs.x()[b] - discs.x()[a], dy=discs.y()[b] - discs.y()[a];
+    const float r=discs.radius()[a] + discs.radius()[b];
+    return dx*dx + dy*dy <= r*r;
+    }
+
+/**
+\brief 'ownsPair' tells whether cell (gx,gy) of 'grid', which registers both overlapping discs
+'a' and 'b', reports them:  whether it is the lowest numbered cell that the grid registers
+both discs in (see UniformGrid::discInCell).  With a == b it tells whether the cell is the
+disc's first.
+
+The grid only registers a disc in the cells its bounding box touches (see
+UniformGrid::boxCellRange), so only the lower numbered cells that both bounding boxes touch
+need a test.  Mostly there are none:  the overlap of the boxes lies clear of the cell's left
+and bottom edges.
+*/
+bool ownsPair (const UniformGrid& grid, const DiscSet& discs, int a, int b, int gx, int gy)
+    {
+    const float ax=discs.x()[a], ay=discs.y()[a], ra=discs.radius()[a];
+    const float bx=discs.x()[b], by=discs.y()[b], rb=discs.radius()[b];
+    const float x0=max(ax-ra,bx-rb), y0=max(ay-ra,by-rb);
+    int left=gx, bottom=gy;
+    while (left > 0 && x0 <= grid.cellX(left))
+	left--;
+    while (bottom > 0 && y0 <= grid.cellY(bottom))
+	bottom--;
+    if (left == gx && bottom == gy)
+	return true;
+
+    const float x1=min(ax+ra,bx+rb);
+    int right=gx;
+    while (right < grid.columns()-1 && x1 >= grid.cellX(right+1))
+	right++;
+    for (int y=bottom;y<=gy;y++)
+	for (int x=left;x<=(y < gy ? right : gx-1);x++)
+	    if (grid.discInCell(ax,ay,ra,x,y) && grid.discInCell(bx,by,rb,x,y))
+		return false;
+    return true;
+    }
+
+/**
+\brief 'addPair' appends the pair (a,b) to 'pairs' in increasing order.
+*/
+inline void addPair (int a, int b, vector<DiscPair>& pairs)
+    {
+    const DiscPair pair={min(a,b),max(a,b)};
+    pairs.push_back(pair);
+    }
+
+/**
+\brief 'levelRowPairs' appends to 'pairs' the overlapping pairs found from rows [row0,row1) of
+level 'k' of 'grid': the pairs of discs of level k reported by their owner cell in those rows,
+and the pairs of a disc of level k centred in those rows with a disc of a finer level.
+*/
+void levelRowPairs (const HierarchicalGrid& grid, const DiscSet& discs, int k, int row0, int row1,
+	vector<DiscPair>& pairs)
+    {
+    const UniformGrid& level=grid.level(k);
+    for (int row=row0;row<row1;row++)
+	for (int column=0;column<level.columns();column++)
+	{
+	const int c=level.cellIndex(column,row);
+	const int* cellDiscs=level.cellDiscs(c);
+	const int n=level.cellNoDiscs(c);
+	for (int i=0;i<n;i++)
+	    {
+	    const int a=cellDiscs[i];
+	    for (int j=i + 1;j<n;j++)
+		if (overlap(discs,a,cellDiscs[j]) && ownsPair(level,discs,a,cellDiscs[j],column,row))
+		    addPair(a,cellDiscs[j],pairs);
+
+	    /* a disc is matched against the finer levels from its first cell only */
+	    if (k == 0 || !ownsPair(level,discs,a,a,column,row))
+		continue;
+	    const float x=discs.x()[a], y=discs.y()[a], r=discs.radius()[a];
+	    for (int f=0;f<k;f++)
+		{
+		const UniformGrid& finer=grid.level(f);
+		if (grid.levelNoDiscs(f) == 0)
+		    continue;
+		int gx0, gy0, gx1, gy1;
+		finer.boxCellRange(x - r,y - r,x + r,y + r,gx0,gy0,gx1,gy1);
+		for (int gy=gy0;gy<=gy1;gy++)
+		    for (int gx=gx0;gx<=gx1;gx++)
+			{
+			if (!finer.discInCell(x,y,r,gx,gy))
+			    continue;
+			const int fc=finer.cellIndex(gx,gy);
+			const int* fineDiscs=finer.cellDiscs(fc);
+			for (int j=0;j<finer.cellNoDiscs(fc);j++)
+			    if (overlap(discs,a,fineDiscs[j]) && ownsPair(finer,discs,a,fineDiscs[j],gx,gy))
+				addPair(a,fineDiscs[j],pairs);
+			}
+		}
+	    }
+	}
+    }
+}
+
+/*******************************************************************************
+    Exported (extern) Functions
+*******************************************************************************/
+/**
+\brief 'findAllPairs' finds the overlapping pairs of 'discs' by walking the cells of every
+level of 'grid'.
+
+A grid registers a disc in every cell it overlaps or touches, so two overlapping or touching
+discs of one level share at least one cell and are tested in each cell they share; the pair
+is reported only from its owner cell (see ownsPair).  That plays the part of the half neighbourhood stencil of
+grids that register discs by centre, without the restriction of the cell size to the largest
+diameter.  A disc of a coarser level is matched against the cells of each finer level that
+its cell range covers, from its first cell, again reporting each pair from the owner cell.  Tasks are bands of
+cell rows of one level.
+*/
+void ITCS4120::DiscCollide::findAllPairs (const HierarchicalGrid& grid, const DiscSet& discs,
+	vector<DiscPair>& pairs, ThreadPool* pool)
+    {
+    if (!pool || pool->size() == 1)
+	{
+	for (int k=0;k<grid.levels();k++)
+	    levelRowPairs(grid,discs,k,0,grid.level(k).rows(),pairs);
+	return;
+	}
+
+    /* the tasks, as (level, first row, end row) */
+    vector<int> tasks;
+    for (int k=0;k<grid.levels();k++)
+	{
+	const int rows=grid.level(k).rows();
+	const int bands=min(rows,pool->size()*4);
+	for (int b=0;b<bands;b++)
+	    {
+	    tasks.push_back(k);
+	    tasks.push_back(rows*b/bands);
+	    tasks.push_back(rows*(b + 1)/bands);
+	    }
+	}
+    const int noTasks=(int)tasks.size()/3;
+    vector<vector<DiscPair> > taskPairs(noTasks);
+    pool->run(noTasks,[&](int t, int)
+	{
+	levelRowPairs(grid,discs,tasks[3*t],tasks[3*t + 1],tasks[3*t + 2],taskPairs[t]);
+	});
+    for (int t=0;t<noTasks;t++)
+	pairs.insert(pairs.end(),taskPairs[t].begin(),taskPairs[t].end());
+    }
+
+/**
+\brief 'findAllPairs' finds the overlapping pairs of 'discs' with any spatial index: each
+alive disc queries 'index' with the square around it and keeps the overlapping candidates of
+higher id.  Tasks are ranges of disc ids.
+*/
+void ITCS4120::DiscCollide::findAllPairs (const SpatialIndex& index, const DiscSet& discs,
+	vector<DiscPair>& pairs, ThreadPool* pool)
+    {
+    const int n=discs.size();
+    const int noTasks= pool ? min(n,pool->size()*8) : 1;
+    vector<vector<DiscPair> > taskPairs(noTasks);
+    const ThreadPool::Task task=[&](int t, int)
+	{
+	vector<int> cells, candidates;
+	for (int a=(int)((long long)n*t/noTasks);a<(int)((long long)n*(t + 1)/noTasks);a++)
+	    {
+	    if (!discs.alive()[a])
+		continue;
+	    const float x=discs.x()[a], y=discs.y()[a], r=discs.radius()[a];
+	    index.boxCandidates(SweptBox(x - r,y,x + r,y,r),cells,candidates);
+	    for (size_t j=0;j<candidates.size();j++)
+		if (candidates[j] > a && overlap(discs,a,candidates[j]))
+		    addPair(a,candidates[j],taskPairs[t]);
+	    }
+	};
+    if (pool)
+	pool->run(noTasks,task);
+    else if (n > 0)
+	task(0,0);
+    for (int t=0;t<noTasks;t++)
+	pairs.insert(pairs.end(),taskPairs[t].begin(),taskPairs[t].end());
+    }
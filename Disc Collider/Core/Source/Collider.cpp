@@ -0,0 +1,406 @@
+/**
+\file Collider.cpp
+\brief Collider.cpp implements the Collider class.
+*/
+#include <DiscCollide/Collider.h>
+#include <DiscCollide/MortonOrder.h>
+#include <DiscCollide/QueryContext.h>
+#include <DiscCollide/SegmentKernel.h>
+
+#include <algorithm>
+#include <math.h>
+
+using namespace std;
+using namespace ITCS4120::DiscCollide;
+
+/*******************************************************************************
+    File Scope Functions
+*******************************************************************************/
+namespace
+{
+/**
+\brief 'appendHits' appends to 'hits' the ids of the batch 'ids' whose bits are set in 'mask'.
+*/
+void appendHits (const int* ids, int n, const unsigned* mask, vector<int>& hits)
+    {
+    for (int w=0;w<hitMaskWords(n);w++)
+	for (unsigned bits=mask[w], i=w*32;bits;bits >>= 1, i++)
+	    if (bits & 1)
+		hits.push_back(ids[i]);
+    }
+}
+
+/*******************************************************************************
+    Exported (extern) Functions
+*******************************************************************************/
+void SweptBoxResult::clear ()
+    {
+    cells.clear();
+    candidates.clear();
+    hits.clear();
+    }
+
+/**
+\brief Construct an empty Collider for 'scene' that keeps its discs in a 'backend' index and
+uses 'pool' for parallel work.  Call generate or setDiscs to populate it.
+*/
+Collider::Collider (const SceneDescription& scene, SpatialBackend backend, ThreadPool& pool) :
+	scene_(scene), pool_(&pool), backend_(backend), traversal_(UniformGrid::TRAVERSAL_DDA), epoch_(0)
+    {
+    }
+
+/**
+\brief 'generate' scatters scene().discCount random discs using 'seed' and builds the grid.
+*/
+void Collider::generate (unsigned seed)
+    {
+    generateDiscs(scene_,seed,discs_);
+    build();
+    }
+
+/**
+\brief 'setDiscs' replaces the discs with 'discs' and builds the grid.
+*/
+void Collider::setDiscs (const DiscSet& discs)
+    {
+    discs_ = discs;
+    scene_.discCount = discs_.size();
+    build();
+    }
+
+/**
+\brief 'build' rebuilds the spatial index from the current discs.  With a backend other
+than the grid, grid() is left an empty grid of the usual layout so that clients can still
+map points to cells.
+*/
+void Collider::build ()
+    {
+    epoch_++;
+    spatialIndex().build(scene_,discs_,*pool_);
+    if (backend_ != SPATIAL_GRID)
+	grid_.build(scene_,DiscSet(),*pool_);
+    }
+
+/**
+\brief 'index' returns the spatial index of the backend chosen at construction.
+*/
+const SpatialIndex& Collider::index () const
+    {
+    if (backend_ == SPATIAL_QUADTREE)
+	return tree_;
+    if (backend_ == SPATIAL_BVH)
+	return bvh_;
+    return grid_;
+    }
+
+SpatialIndex& Collider::spatialIndex ()
+    {
+    if (backend_ == SPATIAL_QUADTREE)
+	return tree_;
+    if (backend_ == SPATIAL_BVH)
+	return bvh_;
+    return grid_;
+    }
+
+/**
+\brief 'segmentQuery' stores in 'hits' the ids (unique) of the discs that
+intersect segment (x1,y1)-(x2,y2).  The cells the segment crosses are listed by the walker
+traversal().
+*/
+void Collider::segmentQuery (float x1, float y1, float x2, float y2, vector<int>& hits) const
+    {
+    const BatchQuery query={x1,y1,x2,y2,0};
+    vector<int> cells, candidates;
+    splitQuery(query,cells,candidates,hits);
+    }
+
+/**
+\brief 'runQuery' appends to 'hits' the ids of the discs hit by 'query' (see BatchQuery).
+'cells', 'candidates' and 'mask' are scratch space that the caller may reuse across queries.
+*/
+void Collider::runQuery (const BatchQuery& query, vector<int>& cells, vector<int>& candidates,
+	vector<unsigned>& mask, vector<int>& hits) const
+    {
+    if (query.halfWidth > 0)
+	index().boxCandidates(SweptBox(query.x1,query.y1,query.x2,query.y2,query.halfWidth),cells,candidates);
+    else
+	index().segmentCandidates(query.x1,query.y1,query.x2,query.y2,traversal_,cells,candidates);
+    if (candidates.empty())
+	return;
+    const int n=(int)candidates.size();
+    mask.resize(hitMaskWords(n));
+    if (query.halfWidth > 0)
+	boxHits(SweptBox(query.x1,query.y1,query.x2,query.y2,query.halfWidth),
+	    discs_.x(),discs_.y(),discs_.radius(),&candidates[0],n,&mask[0]);
+    else
+	segmentHits(Segment(query.x1,query.y1,query.x2,query.y2),
+	    discs_.x(),discs_.y(),discs_.radius(),&candidates[0],n,&mask[0]);
+    appendHits(&candidates[0],n,&mask[0],hits);
+    }
+
+/**
+\brief 'batchQuery' runs every query of 'queries' and stores in 'hits' a (query, disc) pair
+for each disc a query hits, ordered by query index.
+
+The queries are run in the Morton order of the grid() cell they start in, so consecutive
+queries mostly read the same cells and discs, split into contiguous chunks that the pool
+runs in parallel.  Each chunk collects its own hits, which are then scattered to their
+place in query order, so the result does not depend on the number of threads.
+*/
+void Collider::batchQuery (const vector<BatchQuery>& queries, vector<QueryHit>& hits) const
+    {
+    const int n=(int)queries.size();
+    hits.clear();
+    if (n == 0)
+	return;
+
+    vector<unsigned long long> keys(n);
+    vector<int> order(n);
+    for (int i=0;i<n;i++)
+	{
+	keys[i]=mortonCode(grid().cellColumn(queries[i].x1),grid().cellRow(queries[i].y1));
+	order[i]=i;
+	}
+    radixSort(keys,order);
+
+    /* offset[q+1] first counts the hits of query q, then becomes the end of its hits */
+    const int chunks=min(n,pool_->size()*8);
+    vector<vector<QueryHit> > chunkHits(chunks);
+    vector<int> offset(n + 1,0);
+    pool_->run(chunks,[&](int k, int)
+	{
+	vector<int> cells, candidates, discHits;
+	vector<unsigned> mask;
+	const int begin=(int)((long long)n*k/chunks), end=(int)((long long)n*(k + 1)/chunks);
+	for (int i=begin;i<end;i++)
+	    {
+	    const int q=order[i];
+	    discHits.clear();
+	    runQuery(queries[q],cells,candidates,mask,discHits);
+	    offset[q + 1]=(int)discHits.size();
+	    for (size_t j=0;j<discHits.size();j++)
+		{
+		const QueryHit hit={q,discHits[j]};
+		chunkHits[k].push_back(hit);
+		}
+	    }
+	});
+    for (int q=0;q<n;q++)
+	offset[q + 1] += offset[q];
+
+    hits.resize(offset[n]);
+    pool_->run(chunks,[&](int k, int)
+	{
+	const vector<QueryHit>& chunk=chunkHits[k];
+	for (size_t j=0;j<chunk.size();)
+	    {
+	    const int q=chunk[j].query, count=offset[q + 1] - offset[q];
+	    copy(chunk.begin() + j,chunk.begin() + j + count,hits.begin() + offset[q]);
+	    j += count;
+	    }
+	});
+    }
+
+/**
+\brief 'findAllPairs' stores in 'pairs' every pair of alive discs that overlap or touch, each
+once as (a,b) with a < b, and returns their number.  'pairs' is cleared but keeps its
+capacity, so a caller that passes the same vector every frame does not reallocate it.  With
+'parallel' the search runs on the pool, in bands of cell rows for the grid; the pairs come
+out in the same order either way.
+*/
+int Collider::findAllPairs (vector<DiscPair>& pairs, bool parallel) const
+    {
+    pairs.clear();
+    ThreadPool* pool= parallel ? pool_ : 0;
+    if (backend_ == SPATIAL_GRID)
+	ITCS4120::DiscCollide::findAllPairs(grid_,discs_,pairs,pool);
+    else
+	ITCS4120::DiscCollide::findAllPairs(index(),discs_,pairs,pool);
+    return (int)pairs.size();
+    }
+
+/**
+\brief 'sweptBoxQuery' finds the discs hit by the box of half width 'halfWidth' swept from
+(x1,y1) to (x2,y2) (see SweptBox).
+
+The spatial index supplies the candidates and each is tested exactly against the box with
+boxHits; a box of zero half width is tested as its axis segment.  A long box is split across
+the pool (see splitQuery).
+*/
+void Collider::sweptBoxQuery (float x1, float y1, float x2, float y2, float halfWidth, SweptBoxResult& result) const
+    {
+    const SweptBox box(x1,y1,x2,y2,halfWidth);
+    const BatchQuery query={x1,y1,x2,y2,halfWidth};
+    for (int i=0;i<4;i++)
+	box.corner(i,result.corners[i]);
+    splitQuery(query,result.cells,result.candidates,result.hits);
+    }
+
+/**
+\brief 'splitQuery' runs 'query' (see runQuery) and stores in 'cells', 'candidates' and
+'hits' the cells, candidates and hits it finds, each once.
+
+A query more than PIECE_CELLS grid cells long is cut along its axis into pieces that the
+pool runs in parallel, each into its own buffers, so a single field-wide sweep uses every
+core.  The buffers are then merged in piece order, dropping the cells and discs that two
+pieces share.  The hits are those of the whole query; as the piece end points are rounded,
+the cells and candidates may differ from the whole query's in ones the query only touches.
+*/
+void Collider::splitQuery (const BatchQuery& query, vector<int>& cells, vector<int>& candidates,
+	vector<int>& hits) const
+    {
+    const float dx=query.x2 - query.x1, dy=query.y2 - query.y1;
+    const int cellsAlong=(int)(sqrtf(dx*dx + dy*dy)/grid().cellWidth());
+    const int pieces=min(pool_->size()*4,cellsAlong/PIECE_CELLS);
+    hits.clear();
+    if (pool_->size() == 1 || pieces <= 1)
+	{
+	vector<unsigned> mask;
+	runQuery(query,cells,candidates,mask,hits);
+	return;
+	}
+
+    vector<vector<int> > pieceCells(pieces), pieceCandidates(pieces), pieceHits(pieces);
+    pool_->run(pieces,[&](int k, int)
+	{
+	/* the pieces overlap slightly so that rounding leaves no gap between them */
+	const float overlap=0.001f/pieces;
+	const float t0=max(0.0f,(float)k/pieces - overlap), t1=min(1.0f,(float)(k + 1)/pieces + overlap);
+	const BatchQuery piece={query.x1 + t0*dx,query.y1 + t0*dy,query.x1 + t1*dx,query.y1 + t1*dy,query.halfWidth};
+	vector<unsigned> mask;
+	runQuery(piece,pieceCells[k],pieceCandidates[k],mask,pieceHits[k]);
+	});
+
+    QueryContext& context=QueryContext::forThread();
+    cells.clear();
+    candidates.clear();
+    context.begin(grid().cellCount(),discs_.size());
+    for (int k=0;k<pieces;k++)
+	{
+	for (size_t i=0;i<pieceCells[k].size();i++)
+	    if (context.firstCellVisit(pieceCells[k][i]))
+		cells.push_back(pieceCells[k][i]);
+	for (size_t i=0;i<pieceCandidates[k].size();i++)
+	    if (context.firstDiscVisit(pieceCandidates[k][i]))
+		candidates.push_back(pieceCandidates[k][i]);
+	}
+    context.begin(grid().cellCount(),discs_.size());
+    for (int k=0;k<pieces;k++)
+	for (size_t i=0;i<pieceHits[k].size();i++)
+	    if (context.firstDiscVisit(pieceHits[k][i]))
+		hits.push_back(pieceHits[k][i]);
+    }
+
+/**
+\brief 'addDisc' adds a disc of radius 'radius' and colour 'colour' centred at (x,y), registers
+it in the grid and returns its id, which may be that of a removed disc.
+*/
+int Collider::addDisc (float x, float y, float radius, unsigned colour)
+    {
+    const int id=discs_.add(x,y,radius,colour);
+    scene_.discCount = discs_.size();
+    epoch_++;
+    spatialIndex().insert(id,x,y,radius);
+    return id;
+    }
+
+/**
+\brief 'updateDisc' moves disc 'id' to (x,y).  Only the grid cells it leaves or enters are
+updated.
+*/
+void Collider::updateDisc (int id, float x, float y)
+    {
+    epoch_++;
+    if (discs_.alive()[id])
+	spatialIndex().move(id,discs_.x()[id],discs_.y()[id],x,y,discs_.radius()[id]);
+    discs_.x()[id]=x;
+    discs_.y()[id]=y;
+    }
+
+/**
+\brief 'updateDiscs' moves each disc ids[i] to (x[i],y[i]).
+
+Each disc is moved with updateDisc unless more than half of the discs move, when it is
+cheaper to store the new positions and rebuild the grid in parallel.
+*/
+void Collider::updateDiscs (const vector<int>& ids, const vector<float>& x, const vector<float>& y)
+    {
+    if ((int)ids.size() <= discs_.size()/2)
+	{
+	for (size_t i=0;i<ids.size();i++)
+	    updateDisc(ids[i],x[i],y[i]);
+	return;
+	}
+    for (size_t i=0;i<ids.size();i++)
+	{
+	discs_.x()[ids[i]]=x[i];
+	discs_.y()[ids[i]]=y[i];
+	}
+    build();
+    }
+
+/**
+\brief 'removeDisc' removes disc 'id' from the grid and the DiscSet (see removeDiscs).
+*/
+void Collider::removeDisc (int id)
+    {
+    if (!discs_.alive()[id])
+	return;
+    spatialIndex().remove(id,discs_.x()[id],discs_.y()[id],discs_.radius()[id]);
+    discs_.remove(id);
+    epoch_++;
+    }
+
+/**
+\brief 'removeDiscs' removes the discs 'ids'.
+
+Each disc is swapped out of the cells it is registered in and left in the DiscSet as a
+tombstone, so the ids of the other discs stay valid.  The tombstones are only dropped by
+compactIfSparse or compact, which the client calls at a point where it holds no ids it
+cannot remap, e.g. between frames.
+*/
+void Collider::removeDiscs (const vector<int>& ids)
+    {
+    for (size_t i=0;i<ids.size();i++)
+	removeDisc(ids[i]);
+    }
+
+/**
+\brief 'compactIfSparse' compacts (see compact) once a quarter of the DiscSet are tombstones
+and returns true if it did.  It is the maintenance point for removed discs:  called between
+operations, e.g. once a frame, it keeps the tombstones from piling up without renumbering the
+discs under a caller that is still using their ids.
+*/
+bool Collider::compactIfSparse (vector<int>& newId)
+    {
+    if (discs_.removedCount() == 0 || discs_.removedCount() < discs_.size()/4)
+	return false;
+    compact(newId);
+    return true;
+    }
+
+/**
+\brief 'compact' drops the tombstones of removed discs from the DiscSet, renumbering the
+discs in order, and rebuilds the grid.  'newId' receives the new id of every old id, -1 for
+the removed discs, so the caller can remap the ids it keeps.
+*/
+void Collider::compact (vector<int>& newId)
+    {
+    discs_.compact(newId);
+    scene_.discCount = discs_.size();
+    build();
+    }
+
+/**
+\brief 'sortDiscs' renumbers the discs in the Z-order (Morton order) of their grid() cells
+and rebuilds the index.  Discs that are close in the field then sit close in the DiscSet,
+so the candidates of a query occupy far fewer cache lines.  Like compact, this changes the
+disc ids.
+*/
+void Collider::sortDiscs ()
+    {
+    vector<int> order, newId;
+    mortonOrder(grid(),discs_,order);
+    discs_.permute(order,newId);
+    build();
+    }
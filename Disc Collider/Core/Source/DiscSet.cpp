@@ -0,0 +1,123 @@
+/**
+\file DiscSet.cpp
+\brief DiscSet.cpp implements the DiscSet class.
+*/
+#include <DiscCollide/DiscSet.h>
+
+#include <algorithm>
+
+using namespace std;
+using namespace ITCS4120::DiscCollide;
+
+/**
+\brief 'resize' sets the number of discs to 'n'.  New discs are alive, centred at the origin
+and have radius 0 and colour 0.  Removed discs beyond the new size are forgotten.
+*/
+void DiscSet::resize (int n)
+    {
+    free_.erase(remove_if(free_.begin(),free_.end(),[n](int id) {return id >= n;}),free_.end());
+    x_.resize(n,0);
+    y_.resize(n,0);
+    radius_.resize(n,0);
+    colour_.resize(n,0);
+    alive_.resize(n,1);
+    }
+
+/**
+\brief 'clear' removes all discs.
+*/
+void DiscSet::clear ()
+    {
+    resize(0);
+    }
+
+/**
+\brief 'add' adds an alive disc and returns its id.  The id of the disc removed last is
+reused if there is one; otherwise the disc is appended.
+*/
+int DiscSet::add (float x, float y, float radius, unsigned colour)
+    {
+    if (!free_.empty())
+	{
+	const int id=free_.back();
+	free_.pop_back();
+	x_[id]=x;
+	y_[id]=y;
+	radius_[id]=radius;
+	colour_[id]=colour;
+	alive_[id]=1;
+	return id;
+	}
+    x_.push_back(x);
+    y_.push_back(y);
+    radius_.push_back(radius);
+    colour_.push_back(colour);
+    alive_.push_back(1);
+    return size()-1;
+    }
+
+/**
+\brief 'remove' marks disc 'id' as removed and frees its id for reuse.  The disc's data is
+kept as a tombstone until add reuses the id or compact drops it.
+*/
+void DiscSet::remove (int id)
+    {
+    if (!alive_[id])
+	return;
+    alive_[id]=0;
+    free_.push_back(id);
+    }
+
+/**
+\brief 'compact' drops the removed discs, moving the alive ones down in order, and stores in
+'newId' the new id of every old id (-1 for removed discs).
+*/
+void DiscSet::compact (vector<int>& newId)
+    {
+    newId.assign(size(),-1);
+    int n=0;
+    for (int i=0;i<size();i++)
+	{
+	if (!alive_[i])
+	    continue;
+	x_[n]=x_[i];
+	y_[n]=y_[i];
+	radius_[n]=radius_[i];
+	colour_[n]=colour_[i];
+	alive_[n]=1;
+	newId[i]=n++;
+	}
+    free_.clear();
+    resize(n);
+    }
+
+/**
+\brief 'permute' renumbers the discs so that disc order[k] becomes disc k, and stores in
+'newId' the new id of every old id.  'order' must list every id once.  Removed discs keep
+their tombstones and stay reusable.
+*/
+void DiscSet::permute (const vector<int>& order, vector<int>& newId)
+    {
+    const int n=size();
+    FloatArray x(n), y(n), radius(n);
+    ColourArray colour(n);
+    FlagArray alive(n);
+    newId.resize(n);
+    for (int k=0;k<n;k++)
+	{
+	const int i=order[k];
+	x[k]=x_[i];
+	y[k]=y_[i];
+	radius[k]=radius_[i];
+	colour[k]=colour_[i];
+	alive[k]=alive_[i];
+	newId[i]=k;
+	}
+    x_.swap(x);
+    y_.swap(y);
+    radius_.swap(radius);
+    colour_.swap(colour);
+    alive_.swap(alive);
+    for (size_t i=0;i<free_.size();i++)
+	free_[i]=newId[free_[i]];
+    }
@@ -0,0 +1,148 @@
+/**
+\file HierarchicalGrid.cpp
+\brief HierarchicalGrid.cpp implements the HierarchicalGrid class.
+*/
+#include <DiscCollide/HierarchicalGrid.h>
+#include <DiscCollide/QueryContext.h>
+
+#include <algorithm>
+
+using namespace std;
+using namespace ITCS4120::DiscCollide;
+
+/*******************************************************************************
+    Exported (extern) Functions
+*******************************************************************************/
+HierarchicalGrid::HierarchicalGrid ()
+    {
+    baseCellSize_ = 1;
+    }
+
+/**
+\brief 'build' chooses the levels for the radii of the alive 'discs' and builds them using
+'pool'.
+*/
+void HierarchicalGrid::build (const SceneDescription& scene, const DiscSet& discs, ThreadPool& pool)
+    {
+    const long long base=chooseCellSize(scene);
+    baseCellSize_=(int)base;
+    const float extent=max(scene.field[1][0]-scene.field[0][0],scene.field[1][1]-scene.field[0][1]);
+    float maxRadius=0;
+    for (int i=0;i<discs.size();i++)
+	if (discs.alive()[i])
+	    maxRadius=max(maxRadius,discs.radius()[i]);
+
+    int noLevels=1;
+    while (noLevels < MAX_LEVELS && (base << (noLevels-1)) < 2*maxRadius && (base << (noLevels-1)) < extent)
+	noLevels++;
+    levels_.resize(noLevels);
+
+    discLevel_.assign(discs.size(),0);
+    levelNoDiscs_.assign(noLevels,0);
+    for (int i=0;i<discs.size();i++)
+	{
+	discLevel_[i]=(unsigned char)levelFor(discs.radius()[i]);
+	if (discs.alive()[i])
+	    levelNoDiscs_[discLevel_[i]]++;
+	}
+    for (int k=0;k<noLevels;k++)
+	levels_[k].build(scene,(int)(base << k),discs,noLevels>1 ? &discLevel_[0] : 0,k,pool);
+    }
+
+/**
+\brief 'levelFor' returns the lowest level whose cells are at least as wide as a disc of
+radius 'radius', or the top level.
+*/
+int HierarchicalGrid::levelFor (float radius) const
+    {
+    int k=0;
+    while (k+1 < levels() && ((long long)baseCellSize_ << k) < 2*radius)
+	k++;
+    return k;
+    }
+
+/**
+\brief 'insert' registers disc 'id', of radius 'radius' centred at (x,y), in its level.
+*/
+void HierarchicalGrid::insert (int id, float x, float y, float radius)
+    {
+    if (id >= (int)discLevel_.size())
+	discLevel_.resize(id+1,0);
+    discLevel_[id]=(unsigned char)levelFor(radius);
+    levels_[discLevel_[id]].insert(id,x,y,radius);
+    levelNoDiscs_[discLevel_[id]]++;
+    }
+
+/**
+\brief 'remove' drops disc 'id', of radius 'radius' centred at (x,y), from its level.
+*/
+void HierarchicalGrid::remove (int id, float x, float y, float radius)
+    {
+    levels_[discLevel_[id]].remove(id,x,y,radius);
+    levelNoDiscs_[discLevel_[id]]--;
+    }
+
+/**
+\brief 'move' re-registers disc 'id' of radius 'radius' after it moved from (oldX,oldY) to
+(x,y) (see UniformGrid::move).
+*/
+void HierarchicalGrid::move (int id, float oldX, float oldY, float x, float y, float radius)
+    {
+    levels_[discLevel_[id]].move(id,oldX,oldY,x,y,radius);
+    }
+
+/**
+\brief 'gather' stores in 'discs' the discs registered in the cells select(level,cells) lists
+on each level that holds discs, each once.  'cells' is left with the cells of level 0.
+*/
+template <class SelectCells>
+void HierarchicalGrid::gather (SelectCells select, vector<int>& cells, vector<int>& discs) const
+    {
+    QueryContext& context=QueryContext::forThread();
+    vector<int> levelCells;
+    discs.clear();
+    for (int k=0;k<levels();k++)
+	{
+	vector<int>& list= k==0 ? cells : levelCells;
+	if (k > 0 && levelNoDiscs_[k] == 0)
+	    continue;
+	const UniformGrid& grid=levels_[k];
+	select(grid,list);
+	context.begin(grid.cellCount(),(int)discLevel_.size());
+	for (size_t i=0;i<list.size();i++)
+	    {
+	    if (!context.firstCellVisit(list[i]))
+		continue;
+	    const int* cellDiscs=grid.cellDiscs(list[i]);
+	    for (int j=0;j<grid.cellNoDiscs(list[i]);j++)
+		if (context.firstDiscVisit(cellDiscs[j]))
+		    discs.push_back(cellDiscs[j]);
+	    }
+	}
+    }
+
+/**
+\brief 'segmentCandidates' stores in 'discs' the discs registered in the cells segment
+(x1,y1)-(x2,y2) crosses, each once, and in 'cells' those cells of level 0.  'traversal'
+selects the walker (see UniformGrid::selectSegmentCells).
+*/
+void HierarchicalGrid::segmentCandidates (float x1, float y1, float x2, float y2,
+	UniformGrid::Traversal traversal, vector<int>& cells, vector<int>& discs) const
+    {
+    gather([&](const UniformGrid& grid, vector<int>& list)
+	{
+	grid.selectSegmentCells(x1,y1,x2,y2,traversal,list);
+	},cells,discs);
+    }
+
+/**
+\brief 'boxCandidates' stores in 'discs' the discs registered in the cells 'box' overlaps, each
+once, and in 'cells' those cells of level 0.
+*/
+void HierarchicalGrid::boxCandidates (const SweptBox& box, vector<int>& cells, vector<int>& discs) const
+    {
+    gather([&](const UniformGrid& grid, vector<int>& list)
+	{
+	grid.selectBoxCells(box,list);
+	},cells,discs);
+    }
@@ -0,0 +1,385 @@
+/**
+\file LooseQuadtree.cpp
+\brief LooseQuadtree.cpp implements the LooseQuadtree class.
+*/
+#include <DiscCollide/LooseQuadtree.h>
+#include <DiscCollide/SegmentKernel.h>
+
+#include <algorithm>
+#include <math.h>
+
+using namespace std;
+using namespace ITCS4120::DiscCollide;
+
+/*******************************************************************************
+    File Scope Functions
+*******************************************************************************/
+namespace
+{
+/**
+\brief 'overlaps' tells whether 'box', whose axis aligned bounds are 'bounds' (min x, min y,
+max x, max y), overlaps the square of half side 'h' centred at (x,y).  The four separating
+axes of the two rectangles are tested, so the answer is exact.
+*/
+bool overlaps (const SweptBox& box, const float bounds[4], float x, float y, float h)
+    {
+    if (x + h < bounds[0] || y + h < bounds[1] || x - h > bounds[2] || y - h > bounds[3])
+	return false;
+    /* extent of the square projected on either box axis */
+    const float extent=h*(fabsf(box.ux) + fabsf(box.uy));
+    const float along=(x - box.x1)*box.ux + (y - box.y1)*box.uy;
+    if (along + extent < 0 || along - extent > box.length)
+	return false;
+    const float across=(y - box.y1)*box.ux - (x - box.x1)*box.uy;
+    return fabsf(across) <= box.halfWidth + extent;
+    }
+
+/** \brief 'runSize' returns k for a run of 'capacity' == 'minimum' << k slots */
+int runSize (int capacity, int minimum)
+    {
+    int k=0;
+    while ((minimum << k) < capacity)
+	k++;
+    return k;
+    }
+}
+
+/*******************************************************************************
+    Exported (extern) Functions
+*******************************************************************************/
+LooseQuadtree::LooseQuadtree ()
+    {
+    }
+
+/**
+\brief 'build' covers the field of 'scene' with a single root node and inserts the alive
+'discs' one by one; 'pool' is not used.
+*/
+void LooseQuadtree::build (const SceneDescription& scene, const DiscSet& discs, ThreadPool&)
+    {
+    Node root;
+    root.x=(scene.field[0][0] + scene.field[1][0])/2;
+    root.y=(scene.field[0][1] + scene.field[1][1])/2;
+    root.half=max(scene.field[1][0]-scene.field[0][0],scene.field[1][1]-scene.field[0][1])/2;
+    root.depth=0;
+    root.parent=root.children=-1;
+    root.total=0;
+    root.first=root.count=root.capacity=0;
+    nodes_.assign(1,root);
+    freeBlocks_.clear();
+    nodeDiscs_.clear();
+    freeRuns_.clear();
+
+    const int n=discs.size();
+    discNode_.assign(n,-1);
+    discSlot_.assign(n,-1);
+    discX_.assign(n,0);
+    discY_.assign(n,0);
+    discRadius_.assign(n,0);
+    for (int i=0;i<n;i++)
+	if (discs.alive()[i])
+	    insert(i,discs.x()[i],discs.y()[i],discs.radius()[i]);
+    }
+
+/**
+\brief 'depth' returns the depth of the deepest node; the root has depth 0.
+*/
+int LooseQuadtree::depth () const
+    {
+    int deepest=0;
+    vector<int> stack(1,0);
+    while (!stack.empty())
+	{
+	const Node& node=nodes_[stack.back()];
+	stack.pop_back();
+	deepest=max(deepest,node.depth);
+	if (node.children >= 0)
+	    for (int k=0;k<4;k++)
+		stack.push_back(node.children + k);
+	}
+    return deepest;
+    }
+
+/**
+\brief 'allocateBlock' returns the first of four consecutive unused nodes, reusing a freed
+block if there is one.
+*/
+int LooseQuadtree::allocateBlock ()
+    {
+    if (!freeBlocks_.empty())
+	{
+	const int block=freeBlocks_.back();
+	freeBlocks_.pop_back();
+	return block;
+	}
+    nodes_.resize(nodes_.size() + 4);
+    return (int)nodes_.size() - 4;
+    }
+
+/**
+\brief 'allocateRun' returns the first slot of 'capacity' unused consecutive slots of
+nodeDiscs_, reusing a freed run of that size if there is one.
+*/
+int LooseQuadtree::allocateRun (int capacity)
+    {
+    const int k=runSize(capacity,MIN_RUN);
+    if (k < (int)freeRuns_.size() && !freeRuns_[k].empty())
+	{
+	const int first=freeRuns_[k].back();
+	freeRuns_[k].pop_back();
+	return first;
+	}
+    const int first=(int)nodeDiscs_.size();
+    nodeDiscs_.resize(first + capacity);
+    return first;
+    }
+
+/**
+\brief 'freeRun' puts the run of 'capacity' slots starting at 'first' on its free list.
+*/
+void LooseQuadtree::freeRun (int first, int capacity)
+    {
+    const int k=runSize(capacity,MIN_RUN);
+    if (k >= (int)freeRuns_.size())
+	freeRuns_.resize(k+1);
+    freeRuns_[k].push_back(first);
+    }
+
+/**
+\brief 'grow' moves the discs of 'node' to a run twice the size of its full one.
+*/
+void LooseQuadtree::grow (int node)
+    {
+    Node& n=nodes_[node];
+    const int capacity= n.capacity ? 2*n.capacity : (int)MIN_RUN;
+    const int first=allocateRun(capacity);
+    copy(nodeDiscs_.begin() + n.first,nodeDiscs_.begin() + n.first + n.count,nodeDiscs_.begin() + first);
+    if (n.capacity)
+	freeRun(n.first,n.capacity);
+    n.first=first;
+    n.capacity=capacity;
+    }
+
+/**
+\brief 'childFor' returns the child of 'node' that should hold a disc of radius 'radius'
+centred at (x,y), or -1 if the disc belongs in 'node' itself.
+*/
+int LooseQuadtree::childFor (int node, float x, float y, float radius) const
+    {
+    const Node& parent=nodes_[node];
+    if (parent.children < 0 || radius > parent.half/2)
+	return -1;
+    const int c=parent.children + (x >= parent.x ? 1 : 0) + (y >= parent.y ? 2 : 0);
+    const Node& child=nodes_[c];
+    if (fabsf(x - child.x) > child.half || fabsf(y - child.y) > child.half)
+	return -1;
+    return c;
+    }
+
+/**
+\brief 'link' appends disc 'id' to the discs of 'node'.
+*/
+void LooseQuadtree::link (int node, int id)
+    {
+    if (nodes_[node].count == nodes_[node].capacity)
+	grow(node);
+    Node& n=nodes_[node];
+    discNode_[id]=node;
+    discSlot_[id]=n.count;
+    nodeDiscs_[n.first + n.count++]=id;
+    }
+
+/**
+\brief 'unlink' takes disc 'id' out of the discs of its node, moving the last of them into
+its slot.
+*/
+void LooseQuadtree::unlink (int id)
+    {
+    Node& n=nodes_[discNode_[id]];
+    const int last=nodeDiscs_[n.first + --n.count];
+    nodeDiscs_[n.first + discSlot_[id]]=last;
+    discSlot_[last]=discSlot_[id];
+    discNode_[id]=-1;
+    }
+
+/**
+\brief 'place' links disc 'id', of radius 'radius' centred at (x,y), into the deepest existing
+node that may hold it and splits that node if it overflows.
+*/
+void LooseQuadtree::place (int id, float x, float y, float radius)
+    {
+    int node=0, child;
+    nodes_[0].total++;
+    while ((child=childFor(node,x,y,radius)) >= 0)
+	{
+	node=child;
+	nodes_[node].total++;
+	}
+    link(node,id);
+    if (nodes_[node].children < 0 && nodes_[node].count > LEAF_CAPACITY && nodes_[node].depth < MAX_DEPTH)
+	split(node);
+    }
+
+/**
+\brief 'split' gives leaf 'node' four children, moves down the discs that fit them and splits
+the children that overflow in turn.
+*/
+void LooseQuadtree::split (int node)
+    {
+    const int block=allocateBlock();
+    for (int k=0;k<4;k++)
+	{
+	const Node& parent=nodes_[node];
+	Node& child=nodes_[block + k];
+	child.half=parent.half/2;
+	child.x=parent.x + (k & 1 ? child.half : -child.half);
+	child.y=parent.y + (k & 2 ? child.half : -child.half);
+	child.depth=parent.depth + 1;
+	child.parent=node;
+	child.children=-1;
+	child.total=0;
+	child.count=0;
+	}
+    nodes_[node].children=block;
+
+    /* walk backwards, as unlink moves the last disc into the freed slot */
+    for (int i=nodes_[node].count - 1;i >= 0;i--)
+	{
+	const int id=nodeDiscs_[nodes_[node].first + i];
+	const int c=childFor(node,discX_[id],discY_[id],discRadius_[id]);
+	if (c < 0)
+	    continue;
+	unlink(id);
+	link(c,id);
+	nodes_[c].total++;
+	}
+    for (int k=0;k<4;k++)
+	if (nodes_[block + k].count > LEAF_CAPACITY && nodes_[block + k].depth < MAX_DEPTH)
+	    split(block + k);
+    }
+
+/**
+\brief 'mergeUp' folds back into their parent the leaf children of 'node' and of its
+ancestors whose subtree has shrunk to LEAF_CAPACITY/2 discs.
+*/
+void LooseQuadtree::mergeUp (int node)
+    {
+    for (;node >= 0;node=nodes_[node].parent)
+	{
+	const int block=nodes_[node].children;
+	if (block < 0)
+	    continue;
+	if (nodes_[node].total > LEAF_CAPACITY/2)
+	    return;
+	for (int k=0;k<4;k++)
+	    if (nodes_[block + k].children >= 0)
+		return;
+	for (int k=0;k<4;k++)
+	    while (nodes_[block + k].count > 0)
+		{
+		const Node& child=nodes_[block + k];
+		const int id=nodeDiscs_[child.first + child.count - 1];
+		unlink(id);
+		link(node,id);
+		}
+	nodes_[node].children=-1;
+	freeBlocks_.push_back(block);
+	}
+    }
+
+/**
+\brief 'insert' registers disc 'id', of radius 'radius' centred at (x,y).
+*/
+void LooseQuadtree::insert (int id, float x, float y, float radius)
+    {
+    if (id >= (int)discNode_.size())
+	{
+	discNode_.resize(id+1,-1);
+	discSlot_.resize(id+1,-1);
+	discX_.resize(id+1,0);
+	discY_.resize(id+1,0);
+	discRadius_.resize(id+1,0);
+	}
+    discX_[id]=x;
+    discY_[id]=y;
+    discRadius_[id]=radius;
+    place(id,x,y,radius);
+    }
+
+/**
+\brief 'remove' unregisters disc 'id'.
+*/
+void LooseQuadtree::remove (int id, float, float, float)
+    {
+    const int node=discNode_[id];
+    unlink(id);
+    for (int n=node;n >= 0;n=nodes_[n].parent)
+	nodes_[n].total--;
+    mergeUp(node);
+    }
+
+/**
+\brief 'move' re-registers disc 'id' of radius 'radius' after it moved to (x,y).  A disc that
+stays within its node is only relinked if it now fits a child.
+*/
+void LooseQuadtree::move (int id, float, float, float x, float y, float radius)
+    {
+    const int node=discNode_[id];
+    const Node& n=nodes_[node];
+    discX_[id]=x;
+    discY_[id]=y;
+    discRadius_[id]=radius;
+    const bool inside= node==0 || (fabsf(x - n.x) <= n.half && fabsf(y - n.y) <= n.half && radius <= n.half);
+    if (inside && childFor(node,x,y,radius) < 0)
+	return;
+    unlink(id);
+    for (int p=node;p >= 0;p=nodes_[p].parent)
+	nodes_[p].total--;
+    place(id,x,y,radius);
+    mergeUp(node);
+    }
+
+/**
+\brief 'segmentCandidates' stores in 'discs' the discs of the nodes whose loose bounds the
+segment (x1,y1)-(x2,y2) touches; 'traversal' does not apply and 'cells' is left empty.
+*/
+void LooseQuadtree::segmentCandidates (float x1, float y1, float x2, float y2, UniformGrid::Traversal,
+	vector<int>& cells, vector<int>& discs) const
+    {
+    boxCandidates(SweptBox(x1,y1,x2,y2,0),cells,discs);
+    }
+
+/**
+\brief 'boxCandidates' stores in 'discs' the discs of the nodes whose loose bounds 'box'
+overlaps, each once; 'cells' is left empty.  The discs of the root are always candidates, as
+a disc centred outside the field may lie outside the root's loose bounds.
+*/
+void LooseQuadtree::boxCandidates (const SweptBox& box, vector<int>& cells, vector<int>& discs) const
+    {
+    float bounds[4]={box.x1, box.y1, box.x1, box.y1};
+    for (int i=0;i<4;i++)
+	{
+	float p[2];
+	box.corner(i,p);
+	bounds[0]=min(bounds[0],p[0]);
+	bounds[1]=min(bounds[1],p[1]);
+	bounds[2]=max(bounds[2],p[0]);
+	bounds[3]=max(bounds[3],p[1]);
+	}
+
+    cells.clear();
+    discs.clear();
+    int stack[3*MAX_DEPTH + 4], top=0;
+    stack[top++]=0;
+    while (top > 0)
+	{
+	const int index=stack[--top];
+	const Node& node=nodes_[index];
+	if (node.total == 0 || (index != 0 && !overlaps(box,bounds,node.x,node.y,2*node.half)))
+	    continue;
+	discs.insert(discs.end(),nodeDiscs_.begin() + node.first,nodeDiscs_.begin() + node.first + node.count);
+	if (node.children >= 0)
+	    for (int k=3;k >= 0;k--)
+		stack[top++]=node.children + k;
+	}
+    }
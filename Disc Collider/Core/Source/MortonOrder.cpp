@@ -0,0 +1,61 @@
+/**
+\file MortonOrder.cpp
+\brief MortonOrder.cpp implements the Z-order (Morton) sort of the discs.
+*/
+#include <DiscCollide/MortonOrder.h>
+
+using namespace std;
+using namespace ITCS4120::DiscCollide;
+
+/*******************************************************************************
+    Exported (extern) Functions
+*******************************************************************************/
+/**
+\brief 'radixSort' sorts 'keys' in increasing order, applying the same permutation to
+'values'.
+
+The sort is a stable least significant digit radix sort with one pass per byte.  A pass is
+skipped when every key has the same byte there, so keys that fit in 32 bits (or fewer) cost
+no more than a 32 bit sort.
+*/
+void ITCS4120::DiscCollide::radixSort (vector<unsigned long long>& keys, vector<int>& values)
+    {
+    const size_t n=keys.size();
+    vector<unsigned long long> keyBuffer(n);
+    vector<int> valueBuffer(n);
+    for (int shift=0;shift<64;shift+=8)
+	{
+	size_t count[257]={0};
+	for (size_t i=0;i<n;i++)
+	    count[(keys[i] >> shift & 0xFF) + 1]++;
+	if (n == 0 || count[(keys[0] >> shift & 0xFF) + 1] == n)
+	    continue;
+	for (int b=0;b<256;b++)
+	    count[b+1] += count[b];
+	for (size_t i=0;i<n;i++)
+	    {
+	    const size_t to=count[keys[i] >> shift & 0xFF]++;
+	    keyBuffer[to]=keys[i];
+	    valueBuffer[to]=values[i];
+	    }
+	keys.swap(keyBuffer);
+	values.swap(valueBuffer);
+	}
+    }
+
+/**
+\brief 'mortonOrder' stores in 'order' the ids of 'discs' sorted by the Morton code of the
+'grid' cell holding their centre; discs of the same cell keep their order.
+*/
+void ITCS4120::DiscCollide::mortonOrder (const UniformGrid& grid, const DiscSet& discs, vector<int>& order)
+    {
+    const int n=discs.size();
+    vector<unsigned long long> keys(n);
+    order.resize(n);
+    for (int i=0;i<n;i++)
+	{
+	keys[i]=mortonCode(grid.cellColumn(discs.x()[i]),grid.cellRow(discs.y()[i]));
+	order[i]=i;
+	}
+    radixSort(keys,order);
+    }
@@ -0,0 +1,43 @@
+/**
+\file QueryContext.cpp
+\brief QueryContext.cpp implements the QueryContext class.
+*/
+#include <DiscCollide/QueryContext.h>
+
+#include <algorithm>
+
+using namespace std;
+using namespace ITCS4120::DiscCollide;
+
+/*******************************************************************************
+    Exported (extern) Functions
+*******************************************************************************/
+QueryContext::QueryContext () : epoch_(0)
+    {
+    }
+
+/**
+\brief 'begin' starts a query over a grid of 'cells' cells and a DiscSet of 'discs' discs.
+*/
+void QueryContext::begin (int cells, int discs)
+    {
+    if ((int)cellStamp_.size() < cells)
+	cellStamp_.resize(cells,0);
+    if ((int)discStamp_.size() < discs)
+	discStamp_.resize(discs,0);
+    if (++epoch_ == 0)
+	{
+	fill(cellStamp_.begin(),cellStamp_.end(),0u);
+	fill(discStamp_.begin(),discStamp_.end(),0u);
+	epoch_ = 1;
+	}
+    }
+
+/**
+\brief 'forThread' returns the calling thread's own QueryContext.
+*/
+QueryContext& QueryContext::forThread ()
+    {
+    static thread_local QueryContext context;
+    return context;
+    }
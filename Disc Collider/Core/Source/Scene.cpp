@@ -0,0 +1,58 @@
+/**
+\file Scene.cpp
+\brief Scene.cpp implements the SceneDescription helper functions.
+*/
+#include <DiscCollide/Scene.h>
+
+#include <math.h>
+#include <stdlib.h>
+
+using namespace ITCS4120::DiscCollide;
+
+/**
+\brief 'chooseCellSize' returns the grid cell size for 'scene'.
+
+An explicit scene.cellSize is used as given.  Otherwise the cell size is the mean disc spacing,
+which puts about one disc in each cell and balances the number of cells a query walks against
+the number of discs it tests, but no less than a disc's diameter so that a disc is registered
+in at most four cells.
+*/
+int ITCS4120::DiscCollide::chooseCellSize (const SceneDescription& scene)
+    {
+    int size=scene.cellSize;
+    if(size<=0)
+	{
+	float area=(scene.field[1][0]-scene.field[0][0])*(scene.field[1][1]-scene.field[0][1]);
+	size=(int)ceil(sqrt(area/(scene.discCount>0 ? scene.discCount : 1)));
+	if(size<2*scene.discRadius)
+	    size=2*scene.discRadius;
+	}
+    return size>0 ? size : 1;
+    }
+
+/**
+\brief 'generateDiscs' fills 'discs' with scene.discCount discs of radius scene.discRadius
+(or from scene.discRadius to scene.maxDiscRadius) uniformly scattered over scene.field using
+the C library generator seeded with 'seed'.
+Disc colours are set to 0.
+*/
+void ITCS4120::DiscCollide::generateDiscs (const SceneDescription& scene, unsigned seed, DiscSet& discs)
+    {
+    const long width=(long)(scene.field[1][0]-scene.field[0][0]);
+    const long height=(long)(scene.field[1][1]-scene.field[0][1]);
+    discs.clear();
+    discs.resize(scene.discCount);
+    float* x=discs.x();
+    float* y=discs.y();
+    float* radius=discs.radius();
+    srand(seed);
+    for(int i=0;i<scene.discCount;i++)
+	{
+	    // combine two rand() calls since RAND_MAX may be as small as 32767
+	x[i]= (float)((int)scene.field[0][0] + (int)(((long)rand()*(RAND_MAX+1L) + rand()) % width));
+	y[i]= (float)((int)scene.field[0][1] + (int)(((long)rand()*(RAND_MAX+1L) + rand()) % height));
+	radius[i]= (float)scene.discRadius;
+	if(scene.maxDiscRadius>scene.discRadius && scene.discRadius>0)
+	    radius[i]*= (float)pow((double)scene.maxDiscRadius/scene.discRadius,(double)rand()/RAND_MAX);
+	}
+    }
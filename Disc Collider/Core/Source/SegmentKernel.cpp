@@ -0,0 +1,411 @@
+/**
+\file SegmentKernel.cpp
+\brief SegmentKernel.cpp implements the scalar, SSE2 and AVX2 batch segment and box tests and
+the run time selection among them.
+*/
+#include <DiscCollide/SegmentKernel.h>
+
+#include <math.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define DISCCOLLIDE_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// GCC and clang compile a function for an instruction set only when asked to; MSVC always can
+#if defined(__GNUC__)
+#define DISCCOLLIDE_TARGET_SSE2 __attribute__((target("sse2")))
+#define DISCCOLLIDE_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define DISCCOLLIDE_TARGET_SSE2
+#define DISCCOLLIDE_TARGET_AVX2
+#endif
+
+using namespace ITCS4120::DiscCollide;
+
+/*******************************************************************************
+    File Scope Data Types
+*******************************************************************************/
+namespace
+{
+/*
+Each test comes in a scalar form and in SSE2 and AVX2 forms that broadcast the shape once
+and then test four or eight discs per call.  All three do the same single precision
+operations in the same order.
+*/
+
+/**
+\brief ScalarSegment tests whether a disc touches a Segment.  The closest point of the
+segment is found from the clamped projection of the centre onto it.
+*/
+struct ScalarSegment
+    {
+    const Segment& segment;
+    explicit ScalarSegment (const Segment& segment) : segment(segment) {}
+    bool operator() (float px, float py, float r) const
+	{
+	const float ux=px - segment.x1, uy=py - segment.y1;
+	float t=(ux*segment.dx + uy*segment.dy)*segment.invLen2;
+	t = t<0 ? 0 : (t>1 ? 1 : t);
+	const float ex=t*segment.dx - ux, ey=t*segment.dy - uy;
+	return ex*ex + ey*ey <= r*r;
+	}
+    };
+
+/**
+\brief ScalarBox tests whether a disc touches a SweptBox.  The centre is expressed in the
+frame of the box axis and its distance outside the box along and across the axis compared
+with the radius.
+*/
+struct ScalarBox
+    {
+    const SweptBox& box;
+    explicit ScalarBox (const SweptBox& box) : box(box) {}
+    bool operator() (float px, float py, float r) const
+	{
+	const float wx=px - box.x1, wy=py - box.y1;
+	const float along=wx*box.ux + wy*box.uy;
+	const float across=fabsf(wx*box.uy - wy*box.ux);
+	float du=-along > along - box.length ? -along : along - box.length;
+	du = du>0 ? du : 0;
+	float dv=across - box.halfWidth;
+	dv = dv>0 ? dv : 0;
+	return du*du + dv*dv <= r*r;
+	}
+    };
+
+#ifdef DISCCOLLIDE_X86
+struct Sse2Segment
+    {
+    __m128 x1, y1, dx, dy, invLen2, zero, one;
+    DISCCOLLIDE_TARGET_SSE2 explicit Sse2Segment (const Segment& segment)
+	{
+	x1=_mm_set1_ps(segment.x1); y1=_mm_set1_ps(segment.y1);
+	dx=_mm_set1_ps(segment.dx); dy=_mm_set1_ps(segment.dy);
+	invLen2=_mm_set1_ps(segment.invLen2);
+	zero=_mm_setzero_ps(); one=_mm_set1_ps(1);
+	}
+    DISCCOLLIDE_TARGET_SSE2 __m128 operator() (__m128 px, __m128 py, __m128 r) const
+	{
+	const __m128 ux=_mm_sub_ps(px,x1), uy=_mm_sub_ps(py,y1);
+	__m128 t=_mm_mul_ps(_mm_add_ps(_mm_mul_ps(ux,dx),_mm_mul_ps(uy,dy)),invLen2);
+	t=_mm_min_ps(_mm_max_ps(t,zero),one);
+	const __m128 ex=_mm_sub_ps(_mm_mul_ps(t,dx),ux), ey=_mm_sub_ps(_mm_mul_ps(t,dy),uy);
+	return _mm_cmple_ps(_mm_add_ps(_mm_mul_ps(ex,ex),_mm_mul_ps(ey,ey)),_mm_mul_ps(r,r));
+	}
+    };
+
+struct Sse2Box
+    {
+    __m128 x1, y1, ux, uy, length, halfWidth, zero, sign;
+    DISCCOLLIDE_TARGET_SSE2 explicit Sse2Box (const SweptBox& box)
+	{
+	x1=_mm_set1_ps(box.x1); y1=_mm_set1_ps(box.y1);
+	ux=_mm_set1_ps(box.ux); uy=_mm_set1_ps(box.uy);
+	length=_mm_set1_ps(box.length); halfWidth=_mm_set1_ps(box.halfWidth);
+	zero=_mm_setzero_ps(); sign=_mm_set1_ps(-0.0f);
+	}
+    DISCCOLLIDE_TARGET_SSE2 __m128 operator() (__m128 px, __m128 py, __m128 r) const
+	{
+	const __m128 wx=_mm_sub_ps(px,x1), wy=_mm_sub_ps(py,y1);
+	const __m128 along=_mm_add_ps(_mm_mul_ps(wx,ux),_mm_mul_ps(wy,uy));
+	const __m128 across=_mm_andnot_ps(sign,_mm_sub_ps(_mm_mul_ps(wx,uy),_mm_mul_ps(wy,ux)));
+	const __m128 du=_mm_max_ps(_mm_max_ps(_mm_xor_ps(along,sign),_mm_sub_ps(along,length)),zero);
+	const __m128 dv=_mm_max_ps(_mm_sub_ps(across,halfWidth),zero);
+	return _mm_cmple_ps(_mm_add_ps(_mm_mul_ps(du,du),_mm_mul_ps(dv,dv)),_mm_mul_ps(r,r));
+	}
+    };
+
+struct Avx2Segment
+    {
+    __m256 x1, y1, dx, dy, invLen2, zero, one;
+    DISCCOLLIDE_TARGET_AVX2 explicit Avx2Segment (const Segment& segment)
+	{
+	x1=_mm256_set1_ps(segment.x1); y1=_mm256_set1_ps(segment.y1);
+	dx=_mm256_set1_ps(segment.dx); dy=_mm256_set1_ps(segment.dy);
+	invLen2=_mm256_set1_ps(segment.invLen2);
+	zero=_mm256_setzero_ps(); one=_mm256_set1_ps(1);
+	}
+    DISCCOLLIDE_TARGET_AVX2 __m256 operator() (__m256 px, __m256 py, __m256 r) const
+	{
+	const __m256 ux=_mm256_sub_ps(px,x1), uy=_mm256_sub_ps(py,y1);
+	__m256 t=_mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(ux,dx),_mm256_mul_ps(uy,dy)),invLen2);
+	t=_mm256_min_ps(_mm256_max_ps(t,zero),one);
+	const __m256 ex=_mm256_sub_ps(_mm256_mul_ps(t,dx),ux), ey=_mm256_sub_ps(_mm256_mul_ps(t,dy),uy);
+	return _mm256_cmp_ps(_mm256_add_ps(_mm256_mul_ps(ex,ex),_mm256_mul_ps(ey,ey)),_mm256_mul_ps(r,r),_CMP_LE_OQ);
+	}
+    };
+
+struct Avx2Box
+    {
+    __m256 x1, y1, ux, uy, length, halfWidth, zero, sign;
+    DISCCOLLIDE_TARGET_AVX2 explicit Avx2Box (const SweptBox& box)
+	{
+	x1=_mm256_set1_ps(box.x1); y1=_mm256_set1_ps(box.y1);
+	ux=_mm256_set1_ps(box.ux); uy=_mm256_set1_ps(box.uy);
+	length=_mm256_set1_ps(box.length); halfWidth=_mm256_set1_ps(box.halfWidth);
+	zero=_mm256_setzero_ps(); sign=_mm256_set1_ps(-0.0f);
+	}
+    DISCCOLLIDE_TARGET_AVX2 __m256 operator() (__m256 px, __m256 py, __m256 r) const
+	{
+	const __m256 wx=_mm256_sub_ps(px,x1), wy=_mm256_sub_ps(py,y1);
+	const __m256 along=_mm256_add_ps(_mm256_mul_ps(wx,ux),_mm256_mul_ps(wy,uy));
+	const __m256 across=_mm256_andnot_ps(sign,_mm256_sub_ps(_mm256_mul_ps(wx,uy),_mm256_mul_ps(wy,ux)));
+	const __m256 du=_mm256_max_ps(_mm256_max_ps(_mm256_xor_ps(along,sign),_mm256_sub_ps(along,length)),zero);
+	const __m256 dv=_mm256_max_ps(_mm256_sub_ps(across,halfWidth),zero);
+	return _mm256_cmp_ps(_mm256_add_ps(_mm256_mul_ps(du,du),_mm256_mul_ps(dv,dv)),_mm256_mul_ps(r,r),_CMP_LE_OQ);
+	}
+    };
+#endif
+}
+
+/*******************************************************************************
+    File Scope Functions
+*******************************************************************************/
+namespace
+{
+/** \brief test discs first ... n-1 of the batch one at a time */
+template <class Test>
+void scalarHits (const Test& test, const float* x, const float* y, const float* radius,
+	const int* ids, int first, int n, unsigned* mask)
+    {
+    for (int i=first;i<n;i++)
+	{
+	const int id= ids ? ids[i] : i;
+	if (test(x[id],y[id],radius[id]))
+	    mask[i >> 5] |= 1u << (i & 31);
+	}
+    }
+
+#ifdef DISCCOLLIDE_X86
+/** \brief test the batch four discs at a time; the remainder is tested by 'scalar' */
+template <class Test, class Scalar>
+DISCCOLLIDE_TARGET_SSE2 void sse2Hits (const Test& test, const Scalar& scalar, const float* x,
+	const float* y, const float* radius, const int* ids, int n, unsigned* mask)
+    {
+    int i=0;
+    for (;i+4<=n;i+=4)
+	{
+	__m128 px, py, r;
+	if (ids)
+	    {
+	    // SSE2 has no gather
+	    px=_mm_setr_ps(x[ids[i]],x[ids[i+1]],x[ids[i+2]],x[ids[i+3]]);
+	    py=_mm_setr_ps(y[ids[i]],y[ids[i+1]],y[ids[i+2]],y[ids[i+3]]);
+	    r=_mm_setr_ps(radius[ids[i]],radius[ids[i+1]],radius[ids[i+2]],radius[ids[i+3]]);
+	    }
+	else
+	    {
+	    px=_mm_loadu_ps(x + i);
+	    py=_mm_loadu_ps(y + i);
+	    r=_mm_loadu_ps(radius + i);
+	    }
+	mask[i >> 5] |= (unsigned)_mm_movemask_ps(test(px,py,r)) << (i & 31);
+	}
+    scalarHits(scalar,x,y,radius,ids,i,n,mask);
+    }
+
+/** \brief test the batch eight discs at a time; the remainder is tested by 'scalar' */
+template <class Test, class Scalar>
+DISCCOLLIDE_TARGET_AVX2 void avx2Hits (const Test& test, const Scalar& scalar, const float* x,
+	const float* y, const float* radius, const int* ids, int n, unsigned* mask)
+    {
+    int i=0;
+    for (;i+8<=n;i+=8)
+	{
+	__m256 px, py, r;
+	if (ids)
+	    {
+	    const __m256i id=_mm256_loadu_si256((const __m256i*)(ids + i));
+	    px=_mm256_i32gather_ps(x,id,4);
+	    py=_mm256_i32gather_ps(y,id,4);
+	    r=_mm256_i32gather_ps(radius,id,4);
+	    }
+	else
+	    {
+	    px=_mm256_loadu_ps(x + i);
+	    py=_mm256_loadu_ps(y + i);
+	    r=_mm256_loadu_ps(radius + i);
+	    }
+	mask[i >> 5] |= (unsigned)_mm256_movemask_ps(test(px,py,r)) << (i & 31);
+	}
+    scalarHits(scalar,x,y,radius,ids,i,n,mask);
+    }
+
+/** \brief true if the processor and the operating system support AVX2 */
+bool cpuHasAvx2 ()
+    {
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info,0);
+    if (info[0] < 7)
+	return false;
+    __cpuid(info,1);
+    const bool osxsave=(info[2] & (1 << 27)) != 0, avx=(info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 6) != 6)   // XMM and YMM state saved by the OS
+	return false;
+    __cpuidex(info,7,0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+#endif
+    }
+
+/** \brief true if the processor supports SSE2, which every x86-64 processor does */
+bool cpuHasSse2 ()
+    {
+#if defined(__x86_64__) || defined(_M_X64)
+    return true;
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info,1);
+    return (info[3] & (1 << 26)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse2") != 0;
+#endif
+    }
+#endif
+
+/** \brief the kernel used by segmentHits and boxHits */
+SegmentKernel& activeKernel ()
+    {
+    static SegmentKernel kernel=bestSegmentKernel();
+    return kernel;
+    }
+
+/** \brief run the batch with the active kernel; 'Sse2' and 'Avx2' wrap the shape 'Shape' */
+template <class Scalar, class Sse2, class Avx2, class Shape>
+void batchHits (const Shape& shape, const float* x, const float* y, const float* radius,
+	const int* ids, int n, unsigned* mask)
+    {
+    memset(mask,0,hitMaskWords(n)*sizeof(unsigned));
+    switch (activeKernel())
+	{
+#ifdef DISCCOLLIDE_X86
+	case SEGMENT_KERNEL_AVX2:
+	    avx2Hits(Avx2(shape),Scalar(shape),x,y,radius,ids,n,mask);
+	    break;
+	case SEGMENT_KERNEL_SSE2:
+	    sse2Hits(Sse2(shape),Scalar(shape),x,y,radius,ids,n,mask);
+	    break;
+#endif
+	default:
+	    scalarHits(Scalar(shape),x,y,radius,ids,0,n,mask);
+	    break;
+	}
+    }
+}
+
+/*******************************************************************************
+    Exported (extern) Functions
+*******************************************************************************/
+Segment::Segment (float x1, float y1, float x2, float y2) : x1(x1), y1(y1), dx(x2-x1), dy(y2-y1)
+    {
+    const float len2=dx*dx + dy*dy;
+    invLen2= len2>0 ? 1/len2 : 0;
+    }
+
+/**
+\brief Construct the box swept by a segment of length 2*'halfWidth' centred on (x1,y1) and
+perpendicular to its motion to (x2,y2).  A box that does not move is swept in +x.
+*/
+SweptBox::SweptBox (float x1, float y1, float x2, float y2, float halfWidth) :
+	x1(x1), y1(y1), halfWidth(halfWidth)
+    {
+    const float dx=x2-x1, dy=y2-y1;
+    length=sqrtf(dx*dx + dy*dy);
+    ux= length>0 ? dx/length : 1;
+    uy= length>0 ? dy/length : 0;
+    }
+
+/**
+\brief 'corner' stores in 'p' corner 'i' (0 ... 3, counterclockwise from the start corner on
+the right of the axis) of 'box'.
+*/
+void SweptBox::corner (int i, float p[2]) const
+    {
+    const float along= i==1 || i==2 ? length : 0;
+    const float across= i>=2 ? halfWidth : -halfWidth;
+    p[0]=x1 + along*ux - across*uy;
+    p[1]=y1 + along*uy + across*ux;
+    }
+
+/**
+\brief 'segmentHits' sets the mask bits of the discs of the batch that touch 'segment'.  A
+degenerate segment is treated as the point (x1,y1).
+*/
+void ITCS4120::DiscCollide::segmentHits (const Segment& segment, const float* x, const float* y,
+	const float* radius, const int* ids, int n, unsigned* mask)
+    {
+#ifdef DISCCOLLIDE_X86
+    batchHits<ScalarSegment,Sse2Segment,Avx2Segment>(segment,x,y,radius,ids,n,mask);
+#else
+    batchHits<ScalarSegment,ScalarSegment,ScalarSegment>(segment,x,y,radius,ids,n,mask);
+#endif
+    }
+
+/**
+\brief 'boxHits' sets the mask bits of the discs of the batch that touch 'box'.
+*/
+void ITCS4120::DiscCollide::boxHits (const SweptBox& box, const float* x, const float* y,
+	const float* radius, const int* ids, int n, unsigned* mask)
+    {
+#ifdef DISCCOLLIDE_X86
+    batchHits<ScalarBox,Sse2Box,Avx2Box>(box,x,y,radius,ids,n,mask);
+#else
+    batchHits<ScalarBox,ScalarBox,ScalarBox>(box,x,y,radius,ids,n,mask);
+#endif
+    }
+
+/**
+\brief 'bestSegmentKernel' returns the fastest kernel this processor supports.
+*/
+SegmentKernel ITCS4120::DiscCollide::bestSegmentKernel ()
+    {
+#ifdef DISCCOLLIDE_X86
+    if (cpuHasAvx2())
+	return SEGMENT_KERNEL_AVX2;
+    if (cpuHasSse2())
+	return SEGMENT_KERNEL_SSE2;
+#endif
+    return SEGMENT_KERNEL_SCALAR;
+    }
+
+/**
+\brief 'segmentKernel' returns the kernel in use, initially bestSegmentKernel().
+*/
+SegmentKernel ITCS4120::DiscCollide::segmentKernel ()
+    {
+    return activeKernel();
+    }
+
+/**
+\brief 'setSegmentKernel' selects 'kernel', or bestSegmentKernel() if that is slower, and
+returns the kernel selected.  It is meant for benchmarks and must not be called while
+queries run.
+*/
+SegmentKernel ITCS4120::DiscCollide::setSegmentKernel (SegmentKernel kernel)
+    {
+    const SegmentKernel best=bestSegmentKernel();
+    activeKernel() = kernel < best ? kernel : best;
+    return activeKernel();
+    }
+
+/**
+\brief 'segmentKernelName' returns a printable name for 'kernel'.
+*/
+const char* ITCS4120::DiscCollide::segmentKernelName (SegmentKernel kernel)
+    {
+    switch (kernel)
+	{
+	case SEGMENT_KERNEL_AVX2: return "avx2";
+	case SEGMENT_KERNEL_SSE2: return "sse2";
+	default: return "scalar";
+	}
+    }
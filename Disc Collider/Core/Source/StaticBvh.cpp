@@ -0,0 +1,414 @@
+/**
+\file StaticBvh.cpp
+\brief StaticBvh.cpp implements the StaticBvh class.
+*/
+#include <DiscCollide/StaticBvh.h>
+#include <DiscCollide/SegmentKernel.h>
+
+#include <algorithm>
+#include <assert.h>
+#include <float.h>
+#include <math.h>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define DISCCOLLIDE_X86
+#include <emmintrin.h>
+#endif
+
+#if defined(__GNUC__)
+#define DISCCOLLIDE_TARGET_SSE2 __attribute__((target("sse2")))
+#else
+#define DISCCOLLIDE_TARGET_SSE2
+#endif
+
+using namespace std;
+using namespace ITCS4120::DiscCollide;
+
+/*******************************************************************************
+    File Scope Data Types
+*******************************************************************************/
+namespace
+{
+/**
+\brief Box is an axis aligned bounding box; the default one is empty.
+*/
+struct Box
+    {
+    float minX, minY, maxX, maxY;
+    Box () : minX(FLT_MAX), minY(FLT_MAX), maxX(-FLT_MAX), maxY(-FLT_MAX) {}
+    void add (float x0, float y0, float x1, float y1)
+	{
+	minX=min(minX,x0);
+	minY=min(minY,y0);
+	maxX=max(maxX,x1);
+	maxY=max(maxY,y1);
+	}
+    float centreX () const {return (minX + maxX)/2;}
+    float centreY () const {return (minY + maxY)/2;}
+    };
+
+/**
+\brief NodeTest is a SweptBox prepared for the node tests: its bounding box and the absolute
+values of its axis are computed once per query.
+*/
+struct NodeTest
+    {
+    explicit NodeTest (const SweptBox& box) :
+	x1(box.x1), y1(box.y1), ux(box.ux), uy(box.uy), ax(fabsf(box.ux)), ay(fabsf(box.uy)),
+	length(box.length), halfWidth(box.halfWidth)
+	{
+	for (int i=0;i<4;i++)
+	    {
+	    float p[2];
+	    box.corner(i,p);
+	    bounds.add(p[0],p[1],p[0],p[1]);
+	    }
+	}
+
+    Box bounds;
+    float x1, y1, ux, uy, ax, ay, length, halfWidth;
+    };
+}
+
+/*******************************************************************************
+    File Scope Functions
+*******************************************************************************/
+namespace
+{
+/**
+\brief 'strOrder' sorts 'items' in Sort-Tile-Recursive order for nodes of 'fanout' entries:
+into vertical slices by keyX, each holding a square root of the pages, and each slice by
+keyY.  Consecutive runs of 'fanout' items then make compact nodes.
+*/
+template <class KeyX, class KeyY>
+void strOrder (vector<int>& items, KeyX keyX, KeyY keyY, int fanout)
+    {
+    const int n=(int)items.size();
+    const int pages=(n + fanout - 1)/fanout;
+    const int sliceSize=(int)ceil(sqrt((double)pages))*fanout;
+    sort(items.begin(),items.end(),[&](int a, int b) {return keyX(a) < keyX(b);});
+    for (int s=0;s<n;s+=sliceSize)
+	sort(items.begin() + s,items.begin() + min(n,s + sliceSize),[&](int a, int b) {return keyY(a) < keyY(b);});
+    }
+
+/**
+\brief 'scalarNodeHits' returns a mask with bit k set when child k of 'node' overlaps the
+box of 'test'.  The separating axes of the two rectangles are tested, so the answer is
+exact; an empty child fails the first test.
+*/
+int scalarNodeHits (const StaticBvh::Node& node, const NodeTest& test)
+    {
+    int mask=0;
+    for (int k=0;k<4;k++)
+	{
+	if (node.maxX[k] < test.bounds.minX || node.minX[k] > test.bounds.maxX
+		|| node.maxY[k] < test.bounds.minY || node.minY[k] > test.bounds.maxY)
+	    continue;
+	const float hx=(node.maxX[k] - node.minX[k])*0.5f, hy=(node.maxY[k] - node.minY[k])*0.5f;
+	const float dx=(node.minX[k] + node.maxX[k])*0.5f - test.x1;
+	const float dy=(node.minY[k] + node.maxY[k])*0.5f - test.y1;
+	const float along=dx*test.ux + dy*test.uy, alongExtent=hx*test.ax + hy*test.ay;
+	if (along + alongExtent < 0 || along - alongExtent > test.length)
+	    continue;
+	const float across=dy*test.ux - dx*test.uy, acrossExtent=hx*test.ay + hy*test.ax;
+	if (fabsf(across) > test.halfWidth + acrossExtent)
+	    continue;
+	mask |= 1 << k;
+	}
+    return mask;
+    }
+
+#ifdef DISCCOLLIDE_X86
+/**
+\brief 'sse2NodeHits' is scalarNodeHits testing the four children at once.
+*/
+DISCCOLLIDE_TARGET_SSE2 int sse2NodeHits (const StaticBvh::Node& node, const NodeTest& test)
+    {
+    const __m128 minX=_mm_loadu_ps(node.minX), minY=_mm_loadu_ps(node.minY);
+    const __m128 maxX=_mm_loadu_ps(node.maxX), maxY=_mm_loadu_ps(node.maxY);
+    __m128 in=_mm_and_ps(_mm_cmpge_ps(maxX,_mm_set1_ps(test.bounds.minX)),
+	_mm_cmple_ps(minX,_mm_set1_ps(test.bounds.maxX)));
+    in=_mm_and_ps(in,_mm_cmpge_ps(maxY,_mm_set1_ps(test.bounds.minY)));
+    in=_mm_and_ps(in,_mm_cmple_ps(minY,_mm_set1_ps(test.bounds.maxY)));
+
+    const __m128 half=_mm_set1_ps(0.5f);
+    const __m128 ux=_mm_set1_ps(test.ux), uy=_mm_set1_ps(test.uy);
+    const __m128 ax=_mm_set1_ps(test.ax), ay=_mm_set1_ps(test.ay);
+    const __m128 hx=_mm_mul_ps(_mm_sub_ps(maxX,minX),half), hy=_mm_mul_ps(_mm_sub_ps(maxY,minY),half);
+    const __m128 dx=_mm_sub_ps(_mm_mul_ps(_mm_add_ps(minX,maxX),half),_mm_set1_ps(test.x1));
+    const __m128 dy=_mm_sub_ps(_mm_mul_ps(_mm_add_ps(minY,maxY),half),_mm_set1_ps(test.y1));
+
+    const __m128 along=_mm_add_ps(_mm_mul_ps(dx,ux),_mm_mul_ps(dy,uy));
+    const __m128 alongExtent=_mm_add_ps(_mm_mul_ps(hx,ax),_mm_mul_ps(hy,ay));
+    in=_mm_and_ps(in,_mm_cmpge_ps(_mm_add_ps(along,alongExtent),_mm_setzero_ps()));
+    in=_mm_and_ps(in,_mm_cmple_ps(_mm_sub_ps(along,alongExtent),_mm_set1_ps(test.length)));
+
+    const __m128 across=_mm_sub_ps(_mm_mul_ps(dy,ux),_mm_mul_ps(dx,uy));
+    const __m128 acrossExtent=_mm_add_ps(_mm_mul_ps(hx,ay),_mm_mul_ps(hy,ax));
+    const __m128 absAcross=_mm_andnot_ps(_mm_set1_ps(-0.0f),across);
+    in=_mm_and_ps(in,_mm_cmple_ps(absAcross,_mm_add_ps(_mm_set1_ps(test.halfWidth),acrossExtent)));
+    return _mm_movemask_ps(in);
+    }
+#endif
+}
+
+/*******************************************************************************
+    Exported (extern) Functions
+*******************************************************************************/
+StaticBvh::StaticBvh () : height_(0)
+    {
+    }
+
+/**
+\brief 'build' packs a tree over the alive 'discs'; 'pool' is not used.
+*/
+void StaticBvh::build (const SceneDescription&, const DiscSet& discs, ThreadPool&)
+    {
+    const int n=discs.size();
+    discX_.assign(discs.x(),discs.x() + n);
+    discY_.assign(discs.y(),discs.y() + n);
+    discRadius_.assign(discs.radius(),discs.radius() + n);
+    discLeaf_.assign(n,-1);
+    discSlot_.assign(n,-1);
+    for (int i=0;i<n;i++)
+	if (discs.alive()[i])
+	    discLeaf_[i]=IN_OVERFLOW;
+    pack();
+    }
+
+/**
+\brief 'pack' rebuilds the tree over every registered disc and empties the overflow list.
+
+The leaves are cut from the discs in STR order and each level of nodes from the level below
+in STR order, up to a single root.  The nodes are then laid out again breadth first from the
+root, and the discs in the order their leaves are reached.
+*/
+void StaticBvh::pack ()
+    {
+    vector<int> ids;
+    for (int i=0;i<(int)discLeaf_.size();i++)
+	if (discLeaf_[i] != -1)
+	    ids.push_back(i);
+    strOrder(ids,[&](int id) {return discX_[id];},[&](int id) {return discY_[id];},LEAF_SIZE);
+
+    /* the leaves, as runs of 'ids' */
+    const int noLeaves=((int)ids.size() + LEAF_SIZE - 1)/LEAF_SIZE;
+    vector<int> refs(noLeaves);
+    vector<Box> boxes(noLeaves);
+    for (int l=0;l<noLeaves;l++)
+	{
+	refs[l]=-1 - l;
+	for (int i=l*LEAF_SIZE;i<min((int)ids.size(),(l + 1)*LEAF_SIZE);i++)
+	    boxes[l].add(discX_[ids[i]] - discRadius_[ids[i]],discY_[ids[i]] - discRadius_[ids[i]],
+		discX_[ids[i]] + discRadius_[ids[i]],discY_[ids[i]] + discRadius_[ids[i]]);
+	}
+
+    /* the nodes, level by level from the leaves up */
+    vector<Node> built;
+    height_=0;
+    do
+	{
+	vector<int> order(refs.size());
+	for (int i=0;i<(int)order.size();i++)
+	    order[i]=i;
+	strOrder(order,[&](int i) {return boxes[i].centreX();},[&](int i) {return boxes[i].centreY();},4);
+	vector<int> parentRefs;
+	vector<Box> parentBoxes;
+	for (int g=0;g<(int)order.size() || built.empty();g+=4)
+	    {
+	    Node node;
+	    Box parent;
+	    for (int k=0;k<4;k++)
+		{
+		const Box box= g + k < (int)order.size() ? boxes[order[g + k]] : Box();
+		node.minX[k]=box.minX;
+		node.minY[k]=box.minY;
+		node.maxX[k]=box.maxX;
+		node.maxY[k]=box.maxY;
+		node.child[k]= g + k < (int)order.size() ? refs[order[g + k]] : 0;
+		parent.add(box.minX,box.minY,box.maxX,box.maxY);
+		}
+	    parentRefs.push_back((int)built.size());
+	    parentBoxes.push_back(parent);
+	    built.push_back(node);
+	    }
+	refs.swap(parentRefs);
+	boxes.swap(parentBoxes);
+	height_++;
+	}
+    while (refs.size() > 1);
+    assert(height_ <= MAX_HEIGHT);
+
+    /* breadth first layout */
+    nodes_.assign(1,built[refs[0]]);
+    discs_.clear();
+    leafStart_.clear();
+    leafCount_.clear();
+    leafBounds_.clear();
+    overflow_.clear();
+    for (size_t i=0;i<nodes_.size();i++)
+	for (int k=0;k<4;k++)
+	    {
+	    if (nodes_[i].minX[k] > nodes_[i].maxX[k])
+		continue;
+	    const int child=nodes_[i].child[k];
+	    if (child >= 0)
+		{
+		nodes_[i].child[k]=(int)nodes_.size();
+		nodes_.push_back(built[child]);
+		continue;
+		}
+	    const int leaf=(int)leafStart_.size(), first=(-1 - child)*LEAF_SIZE;
+	    const int last=min((int)ids.size(),first + LEAF_SIZE);
+	    nodes_[i].child[k]=-1 - leaf;
+	    leafStart_.push_back((int)discs_.size());
+	    leafCount_.push_back(last - first);
+	    leafBounds_.push_back(nodes_[i].minX[k]);
+	    leafBounds_.push_back(nodes_[i].minY[k]);
+	    leafBounds_.push_back(nodes_[i].maxX[k]);
+	    leafBounds_.push_back(nodes_[i].maxY[k]);
+	    for (int j=first;j<last;j++)
+		{
+		discLeaf_[ids[j]]=leaf;
+		discSlot_[ids[j]]=(int)discs_.size();
+		discs_.push_back(ids[j]);
+		}
+	    }
+    }
+
+/**
+\brief 'fitsLeaf' tells whether the disc of radius 'radius' centred at (x,y) lies within the
+box of 'leaf'.
+*/
+bool StaticBvh::fitsLeaf (int leaf, float x, float y, float radius) const
+    {
+    const float* bounds=&leafBounds_[4*leaf];
+    return x - radius >= bounds[0] && y - radius >= bounds[1] && x + radius <= bounds[2] && y + radius <= bounds[3];
+    }
+
+/**
+\brief 'addToOverflow' appends disc 'id' to the overflow list and packs the tree again when
+the list has grown too long.
+*/
+void StaticBvh::addToOverflow (int id)
+    {
+    discLeaf_[id]=IN_OVERFLOW;
+    discSlot_[id]=(int)overflow_.size();
+    overflow_.push_back(id);
+    if ((int)overflow_.size() > max(64,(int)discs_.size()/16))
+	pack();
+    }
+
+/**
+\brief 'dropFromLeaf' takes disc 'id' out of its leaf or of the overflow list, moving the last
+disc of that into its slot.
+*/
+void StaticBvh::dropFromLeaf (int id)
+    {
+    const int slot=discSlot_[id];
+    int last;
+    if (discLeaf_[id] == IN_OVERFLOW)
+	{
+	last=overflow_.back();
+	overflow_[slot]=last;
+	overflow_.pop_back();
+	}
+    else
+	{
+	const int leaf=discLeaf_[id];
+	last=discs_[leafStart_[leaf] + --leafCount_[leaf]];
+	discs_[slot]=last;
+	}
+    discSlot_[last]=slot;
+    discLeaf_[id]=-1;
+    }
+
+/**
+\brief 'insert' registers disc 'id', of radius 'radius' centred at (x,y), in the overflow
+list.
+*/
+void StaticBvh::insert (int id, float x, float y, float radius)
+    {
+    if (id >= (int)discLeaf_.size())
+	{
+	discLeaf_.resize(id+1,-1);
+	discSlot_.resize(id+1,-1);
+	discX_.resize(id+1,0);
+	discY_.resize(id+1,0);
+	discRadius_.resize(id+1,0);
+	}
+    discX_[id]=x;
+    discY_[id]=y;
+    discRadius_[id]=radius;
+    addToOverflow(id);
+    }
+
+/**
+\brief 'remove' unregisters disc 'id'.
+*/
+void StaticBvh::remove (int id, float, float, float)
+    {
+    dropFromLeaf(id);
+    }
+
+/**
+\brief 'move' re-registers disc 'id' of radius 'radius' after it moved to (x,y).  The disc
+stays in its leaf if it still fits the leaf's box, and goes to the overflow list otherwise.
+*/
+void StaticBvh::move (int id, float, float, float x, float y, float radius)
+    {
+    discX_[id]=x;
+    discY_[id]=y;
+    discRadius_[id]=radius;
+    if (discLeaf_[id] == IN_OVERFLOW || fitsLeaf(discLeaf_[id],x,y,radius))
+	return;
+    dropFromLeaf(id);
+    addToOverflow(id);
+    }
+
+/**
+\brief 'segmentCandidates' stores in 'discs' the discs of the leaves whose boxes the segment
+(x1,y1)-(x2,y2) touches and those of the overflow list; 'traversal' does not apply and
+'cells' is left empty.
+*/
+void StaticBvh::segmentCandidates (float x1, float y1, float x2, float y2, UniformGrid::Traversal,
+	vector<int>& cells, vector<int>& discs) const
+    {
+    boxCandidates(SweptBox(x1,y1,x2,y2,0),cells,discs);
+    }
+
+/**
+\brief 'boxCandidates' stores in 'discs' the discs of the leaves whose boxes 'box' overlaps
+and those of the overflow list, each once; 'cells' is left empty.
+*/
+void StaticBvh::boxCandidates (const SweptBox& box, vector<int>& cells, vector<int>& discs) const
+    {
+    const NodeTest test(box);
+#ifdef DISCCOLLIDE_X86
+    int (*nodeHits)(const Node&, const NodeTest&)= segmentKernel() == SEGMENT_KERNEL_SCALAR ? scalarNodeHits : sse2NodeHits;
+#else
+    int (*nodeHits)(const Node&, const NodeTest&)=scalarNodeHits;
+#endif
+
+    cells.clear();
+    discs.clear();
+    /* each node pops one entry and pushes at most four, so the stack holds at most three
+       entries per level below the root and the root */
+    int stack[3*MAX_HEIGHT + 4], top=0;
+    stack[top++]=0;
+    while (top > 0)
+	{
+	const Node& node=nodes_[stack[--top]];
+	const int mask=nodeHits(node,test);
+	for (int k=0;k<4;k++)
+	    if (mask & 1 << k && node.child[k] < 0)
+		{
+		const int* leaf=&discs_[0] + leafStart_[-1 - node.child[k]];
+		discs.insert(discs.end(),leaf,leaf + leafCount_[-1 - node.child[k]]);
+		}
+	for (int k=3;k >= 0;k--)
+	    if (mask & 1 << k && node.child[k] >= 0)
+		stack[top++]=node.child[k];
+	}
+    discs.insert(discs.end(),overflow_.begin(),overflow_.end());
+    }
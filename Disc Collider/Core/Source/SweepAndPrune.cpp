@@ -0,0 +1,204 @@
+/**
+\file SweepAndPrune.cpp
+\brief SweepAndPrune.cpp implements the SweepAndPrune class.
+*/
+#include <DiscCollide/SweepAndPrune.h>
+
+#include <algorithm>
+#include <float.h>
+
+using namespace std;
+using namespace ITCS4120::DiscCollide;
+
+/*******************************************************************************
+    File Scope Functions
+*******************************************************************************/
+namespace
+{
+/**
+\brief 'before' orders box ends by value, lower ends first among equal values so that
+touching boxes overlap.
+*/
+template <class Endpoint> inline bool before (const Endpoint& a, const Endpoint& b)
+    {
+    return a.value < b.value || (a.value == b.value && (a.end & 1) < (b.end & 1));
+    }
+
+/**
+\brief 'boxesOverlap' tells whether the boxes 'a' and 'b' overlap or touch.
+*/
+template <class Box> inline bool boxesOverlap (const Box& a, const Box& b)
+    {
+    return a.lo[0] <= b.hi[0] && b.lo[0] <= a.hi[0] && a.lo[1] <= b.hi[1] && b.lo[1] <= a.hi[1];
+    }
+
+inline unsigned long long pairKey (int a, int b)
+    {
+    return (unsigned long long)min(a,b) << 32 | (unsigned)max(a,b);
+    }
+}
+
+/*******************************************************************************
+    Exported (extern) Functions
+*******************************************************************************/
+SweepAndPrune::SweepAndPrune ()
+    {
+    count_=0;
+    swaps_=0;
+    }
+
+/**
+\brief 'build' sorts the box ends of 'discs' from scratch and finds the overlapping boxes by
+sweeping the x ends once.  Call it again after the discs are renumbered (DiscSet::permute,
+Collider::compact or Collider::sortDiscs).
+*/
+void SweepAndPrune::build (const DiscSet& discs)
+    {
+    count_=discs.size();
+    swaps_=0;
+    readBoxes(discs);
+    for (int axis=0;axis<2;axis++)
+	{
+	ends_[axis].resize(2*count_);
+	for (int i=0;i<2*count_;i++)
+	    {
+	    const Box& box=boxes_[i >> 1].box;
+	    ends_[axis][i].value= (i & 1) ? box.hi[axis] : box.lo[axis];
+	    ends_[axis][i].end=i;
+	    }
+	sort(ends_[axis].begin(),ends_[axis].end(),before<Endpoint>);
+	}
+
+    /* the discs whose x interval contains the sweep position, with each one's place in it */
+    boxPairs_.clear();
+    vector<int> open, place(count_);
+    for (size_t i=0;i<ends_[0].size();i++)
+	{
+	const int disc=ends_[0][i].end >> 1;
+	if (!discs.alive()[disc])
+	    continue;
+	if (ends_[0][i].end & 1)
+	    {
+	    place[open.back()]=place[disc];
+	    open[place[disc]]=open.back();
+	    open.pop_back();
+	    continue;
+	    }
+	for (size_t j=0;j<open.size();j++)
+	    if (boxesOverlap(boxes_[disc].box,boxes_[open[j]].box))
+		boxPairs_.insert(pairKey(disc,open[j]));
+	place[disc]=(int)open.size();
+	open.push_back(disc);
+	}
+    }
+
+/**
+\brief 'update' moves the box ends to the current positions of 'discs' and restores their
+order, updating the overlapping boxes along the way.  A change in the number of discs
+rebuilds from scratch.
+*/
+void SweepAndPrune::update (const DiscSet& discs)
+    {
+    if (discs.size() != count_)
+	{
+	build(discs);
+	return;
+	}
+    swaps_=0;
+    readBoxes(discs);
+    for (int axis=0;axis<2;axis++)
+	{
+	vector<Endpoint>& ends=ends_[axis];
+	for (size_t i=0;i<ends.size();i++)
+	    {
+	    const Box& box=boxes_[ends[i].end >> 1].box;
+	    ends[i].value= (ends[i].end & 1) ? box.hi[axis] : box.lo[axis];
+	    }
+	sortAxis(axis);
+	}
+    }
+
+/**
+\brief 'findPairs' stores in 'pairs' the pairs of overlapping boxes whose discs overlap too.
+'pairs' is cleared but keeps its capacity; the pairs are in no particular order.
+*/
+void SweepAndPrune::findPairs (const DiscSet& discs, vector<DiscPair>& pairs) const
+    {
+    pairs.clear();
+    for (unordered_set<unsigned long long>::const_iterator p=boxPairs_.begin();p != boxPairs_.end();++p)
+	{
+	const int a=(int)(*p >> 32), b=(int)(unsigned)*p;
+	const float dx=discs.x()[b] - discs.x()[a], dy=discs.y()[b] - discs.y()[a];
+	const float r=discs.radius()[a] + discs.radius()[b];
+	if (dx*dx + dy*dy <= r*r)
+	    {
+	    const DiscPair pair={a,b};
+	    pairs.push_back(pair);
+	    }
+	}
+    }
+
+/**
+\brief 'readBoxes' stores in 'boxes_' the bounding boxes of 'discs', keeping the previous
+ones as the old boxes.
+*/
+void SweepAndPrune::readBoxes (const DiscSet& discs)
+    {
+    boxes_.resize(count_);
+    for (int i=0;i<count_;i++)
+	{
+	boxes_[i].oldBox=boxes_[i].box;
+	Box& box=boxes_[i].box;
+	if (!discs.alive()[i])
+	    {
+	    box.lo[0]=box.lo[1]=FLT_MAX;
+	    box.hi[0]=box.hi[1]=-FLT_MAX;
+	    continue;
+	    }
+	const float r=discs.radius()[i];
+	box.lo[0]=discs.x()[i] - r;
+	box.lo[1]=discs.y()[i] - r;
+	box.hi[0]=discs.x()[i] + r;
+	box.hi[1]=discs.y()[i] + r;
+	}
+    }
+
+/**
+\brief 'sortAxis' insertion sorts the ends along 'axis'.
+
+A lower end passing an upper end means the two boxes may have started to overlap; an upper
+end passing a lower end means they may no longer do.  Insertion sort swaps two ends at most
+once, so the swaps agree with the final boxes and only a pair whose overlap differs between
+the old and the new boxes changes 'boxPairs_'.
+*/
+void SweepAndPrune::sortAxis (int axis)
+    {
+    vector<Endpoint>& ends=ends_[axis];
+    for (size_t i=1;i<ends.size();i++)
+	{
+	const Endpoint e=ends[i];
+	size_t j=i;
+	for (;j > 0 && before(e,ends[j - 1]);j--)
+	    {
+	    const Endpoint& passed=ends[j - 1];
+	    /* a lower and an upper end of two discs:  a disc that is removed or added back
+	       passes its own ends, which says nothing about a pair */
+	    if ((e.end & 1) != (passed.end & 1) && (e.end >> 1) != (passed.end >> 1))
+		{
+		const DiscBoxes& a=boxes_[e.end >> 1];
+		const DiscBoxes& b=boxes_[passed.end >> 1];
+		const bool was=boxesOverlap(a.oldBox,b.oldBox);
+		if (e.end & 1)
+		    {
+		    if (was)
+			boxPairs_.erase(pairKey(e.end >> 1,passed.end >> 1));
+		    }
+		else if (!was && boxesOverlap(a.box,b.box))
+		    boxPairs_.insert(pairKey(e.end >> 1,passed.end >> 1));
+		}
+	    ends[j]=passed;
+	    }
+	swaps_ += i - j;
+	ends[j]=e;
+	}
+    }
@@ -0,0 +1,203 @@
+/**
+\file ThreadPool.cpp
+\brief ThreadPool.cpp implements the ThreadPool class.
+*/
+#include <DiscCollide/ThreadPool.h>
+
+using namespace std;
+using namespace ITCS4120::DiscCollide;
+
+/*******************************************************************************
+    File Scope (static/private) globals
+*******************************************************************************/
+namespace
+{
+/** true on threads currently running ThreadPool tasks; nested runs go serial */
+thread_local bool inPool = false;
+
+/** \brief 'packRange' packs the task range [begin,end) into one word */
+inline unsigned long long packRange (unsigned begin, unsigned end)
+    {
+    return (unsigned long long)end << 32 | begin;
+    }
+}
+
+/*******************************************************************************
+    Exported (extern) Functions
+*******************************************************************************/
+/**
+\brief Construct a ThreadPool of size() 'threads', or one thread per hardware thread if
+'threads' is 0.
+*/
+ThreadPool::ThreadPool (int threads)
+    {
+    if (threads<=0)
+	threads = (int)thread::hardware_concurrency();
+    if (threads<1)
+	threads = 1;
+    task_ = 0;
+    tasks_ = 0;
+    ranges_.reset(new TaskRange[threads]);
+    for (int i=0;i<threads;i++)
+	ranges_[i].range = 0;
+    busy_ = 0;
+    generation_ = 0;
+    stop_ = false;
+    for (int i=1;i<threads;i++)
+	workers_.push_back(thread(&ThreadPool::workerLoop,this,i));
+    }
+
+ThreadPool::~ThreadPool ()
+    {
+	{
+	lock_guard<mutex> lock(mutex_);
+	stop_ = true;
+	}
+    wake_.notify_all();
+    for (size_t i=0;i<workers_.size();i++)
+	workers_[i].join();
+    }
+
+/**
+\brief 'shared' returns a process wide ThreadPool with one thread per hardware thread.
+*/
+ThreadPool& ThreadPool::shared ()
+    {
+    static ThreadPool pool;
+    return pool;
+    }
+
+/**
+\brief 'run' calls task(i,thread) for every i in [0,tasks) and returns when all calls have
+finished.  Thread t starts on the tasks [tasks*t/size(), tasks*(t+1)/size()) and runs them
+in increasing order, then steals from the others (see steal).
+*/
+void ThreadPool::run (int tasks, const Task& task)
+    {
+    if (tasks<=0)
+	return;
+    if (tasks==1 || workers_.empty() || inPool)
+	{
+	for (int i=0;i<tasks;i++)
+	    task(i,0);
+	return;
+	}
+
+    lock_guard<mutex> runLock(runMutex_);
+	{
+	lock_guard<mutex> lock(mutex_);
+	task_ = &task;
+	tasks_ = tasks;
+	const long long threads=size();
+	for (int t=0;t<threads;t++)
+	    ranges_[t].range = packRange((unsigned)(tasks*t/threads),(unsigned)(tasks*(t + 1)/threads));
+	busy_ = (int)workers_.size();
+	generation_++;
+	}
+    wake_.notify_all();
+
+    inPool = true;
+    drain(0);
+    inPool = false;
+
+    unique_lock<mutex> lock(mutex_);
+    while (busy_>0)
+	done_.wait(lock);
+    task_ = 0;
+    }
+
+/**
+\brief 'drain' runs tasks of the current job on thread 'thread' until none are left.
+*/
+void ThreadPool::drain (int thread)
+    {
+    do
+	{
+	for (int i=take(thread); i>=0; i=take(thread))
+	    (*task_)(i,thread);
+	}
+    while (steal(thread));
+    }
+
+/**
+\brief 'take' removes the first task from the share of 'thread' and returns it, or returns
+-1 if the share is empty.
+*/
+int ThreadPool::take (int thread)
+    {
+    atomic<unsigned long long>& range=ranges_[thread].range;
+    unsigned long long r=range.load();
+    for (;;)
+	{
+	const unsigned begin=(unsigned)r, end=(unsigned)(r >> 32);
+	if (begin>=end)
+	    return -1;
+	if (range.compare_exchange_weak(r,packRange(begin + 1,end)))
+	    return (int)begin;
+	}
+    }
+
+/**
+\brief 'steal' moves the back half (at least one task) of the largest share of the other
+threads to the empty share of 'thread'.  It returns false when no thread has a task left.
+*/
+bool ThreadPool::steal (int thread)
+    {
+    const int threads=size();
+    for (;;)
+	{
+	int victim=-1;
+	unsigned most=0;
+	for (int k=1;k<threads;k++)
+	    {
+	    const int t=(thread + k) % threads;
+	    const unsigned long long r=ranges_[t].range.load();
+	    const unsigned begin=(unsigned)r, end=(unsigned)(r >> 32);
+	    if (begin<end && end - begin>most)
+		{
+		victim = t;
+		most = end - begin;
+		}
+	    }
+	if (victim<0)
+	    return false;
+
+	atomic<unsigned long long>& range=ranges_[victim].range;
+	unsigned long long r=range.load();
+	const unsigned begin=(unsigned)r, end=(unsigned)(r >> 32);
+	if (begin>=end)
+	    continue;
+	const unsigned middle=begin + (end - begin)/2;
+	if (range.compare_exchange_strong(r,packRange(begin,middle)))
+	    {
+	    ranges_[thread].range = packRange(middle,end);
+	    return true;
+	    }
+	}
+    }
+
+/**
+\brief 'workerLoop' is the body of worker thread 'thread'.
+*/
+void ThreadPool::workerLoop (int thread)
+    {
+    unsigned seen = 0;
+    inPool = true;
+    for (;;)
+	{
+	    {
+	    unique_lock<mutex> lock(mutex_);
+	    while (!stop_ && generation_==seen)
+		wake_.wait(lock);
+	    if (stop_)
+		return;
+	    seen = generation_;
+	    }
+	drain(thread);
+	    {
+	    lock_guard<mutex> lock(mutex_);
+	    if (--busy_==0)
+		done_.notify_one();
+	    }
+	}
+    }
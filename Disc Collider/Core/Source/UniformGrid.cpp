@@ -0,0 +1,745 @@
+/**
+\file UniformGrid.cpp
+\brief UniformGrid.cpp implements the UniformGrid class.
+*/
+#include <DiscCollide/UniformGrid.h>
+#include <DiscCollide/SegmentKernel.h>
+
+#include <algorithm>
+#include <math.h>
+#include <stdlib.h>
+
+using namespace std;
+using namespace ITCS4120::DiscCollide;
+
+/*******************************************************************************
+    File Scope Data Types
+*******************************************************************************/
+namespace
+{
+/**
+\brief CellVisitor appends the cell containing a world coordinate point to a cell list.
+It stands in for the setPixel of the line drawing algorithm the cell walker derives from.
+*/
+struct CellVisitor
+    {
+    const UniformGrid& grid;
+    vector<int>& cells;
+    CellVisitor (const UniformGrid& grid, vector<int>& cells) : grid(grid), cells(cells) {}
+    void operator() (int x, int y) {cells.push_back(grid.cellIndex(grid.cellColumn(x),grid.cellRow(y)));}
+    };
+
+/**
+\brief CellList collects the cells of one disc.  Most discs overlap a handful of cells, which
+are kept in place; larger discs spill to the heap.
+*/
+class CellList
+    {
+    public:
+    CellList () : size_(0) {}
+    void push_back (int c)
+	{
+	if (size_ < LOCAL_CELLS)
+	    local_[size_]=c;
+	else
+	    {
+	    if (size_ == LOCAL_CELLS)
+		heap_.assign(local_,local_ + LOCAL_CELLS);
+	    heap_.push_back(c);
+	    }
+	size_++;
+	}
+    int size () const {return size_;}
+    int operator[] (int i) const {return size_ > LOCAL_CELLS ? heap_[i] : local_[i];}
+
+    private:
+    enum {LOCAL_CELLS=16};
+    int local_[LOCAL_CELLS];
+    std::vector<int> heap_;
+    int size_;
+    };
+}
+
+/*******************************************************************************
+    File Scope Functions
+*******************************************************************************/
+namespace
+{
+/** \brief first item of block 'b' when 'items' items are split into 'blocks' contiguous blocks */
+inline int blockBegin (int b, int blocks, int items)
+    {
+    return (int)((long long)items*b/blocks);
+    }
+}
+
+/*******************************************************************************
+    Exported (extern) Functions
+*******************************************************************************/
+UniformGrid::UniformGrid ()
+    {
+    origin_[0] = origin_[1] = 0;
+    columns_ = rows_ = 0;
+    cellWidth_ = cellHeight_ = 1;
+    abandoned_ = 0;
+    }
+
+/**
+\brief 'cellColumn' returns the grid column containing world x coordinate 'x', clamped to the grid.
+*/
+int UniformGrid::cellColumn (float x) const
+    {
+    int gx=(int)floor((x-origin_[0])/cellWidth_);
+    return gx<0 ? 0 : (gx>=columns_ ? columns_-1 : gx);
+    }
+
+/**
+\brief 'cellRow' returns the grid row containing world y coordinate 'y', clamped to the grid.
+*/
+int UniformGrid::cellRow (float y) const
+    {
+    int gy=(int)floor((y-origin_[1])/cellHeight_);
+    return gy<0 ? 0 : (gy>=rows_ ? rows_-1 : gy);
+    }
+
+/**
+\brief 'boxCellRange' stores in [gx0,gx1] x [gy0,gy1] the range of cells, clamped to the grid,
+that the box [x0,x1] x [y0,y1] touches.  A box edge on a cell boundary touches the cells on
+both sides.  The range is settled by comparing the box with the cell edges, so rounding in
+cellColumn and cellRow cannot change it.
+*/
+void UniformGrid::boxCellRange (float x0, float y0, float x1, float y1, int& gx0, int& gy0, int& gx1, int& gy1) const
+    {
+    gx0=cellColumn(x0);
+    gx1=cellColumn(x1);
+    gy0=cellRow(y0);
+    gy1=cellRow(y1);
+    while (gx0 > 0 && x0 <= cellX(gx0))
+	gx0--;
+    while (gx0 < columns_-1 && x0 > cellX(gx0+1))
+	gx0++;
+    while (gx1 < columns_-1 && x1 >= cellX(gx1+1))
+	gx1++;
+    while (gx1 > 0 && x1 < cellX(gx1))
+	gx1--;
+    while (gy0 > 0 && y0 <= cellY(gy0))
+	gy0--;
+    while (gy0 < rows_-1 && y0 > cellY(gy0+1))
+	gy0++;
+    while (gy1 < rows_-1 && y1 >= cellY(gy1+1))
+	gy1++;
+    while (gy1 > 0 && y1 < cellY(gy1))
+	gy1--;
+    }
+
+/**
+\brief 'forEachDiscCell' calls visit(c), in increasing order of c, for every grid cell c that
+the disc of radius 'r' centred at (x,y) overlaps or touches.
+
+Each cell in the boxCellRange of the disc's bounding box is classified exactly with a closest point test:  the
+disc is registered in the cell if the point of the cell nearest the disc's centre lies in
+the closed disc (see discInCell).  Cells only touched by the disc's boundary are included, so
+two discs that touch are both registered in the cell, or cells, holding their point of
+contact.  This handles discs of any size relative to a cell.  A disc lying entirely outside
+the grid overlaps no cell.
+*/
+template <class Visit>
+void UniformGrid::forEachDiscCell (float x, float y, float r, Visit visit) const
+    {
+    const float r2=r*r;
+    int gx0, gy0, gx1, gy1;
+    boxCellRange(x-r,y-r,x+r,y+r,gx0,gy0,gx1,gy1);
+
+    for(int gy=gy0;gy<=gy1;gy++)
+	{
+	    //distance from the disc centre to the row's y range
+	const float ey=cellGap(y,(float)cellY(gy),cellHeight_);
+	if(ey*ey>r2)
+	    continue;
+	for(int gx=gx0;gx<=gx1;gx++)
+	    {
+	    const float ex=cellGap(x,(float)cellX(gx),cellWidth_);
+	    if(ex*ex + ey*ey<=r2)
+		visit(cellIndex(gx,gy));
+	    }
+	}
+    }
+
+/**
+\brief 'build' sizes the grid for 'scene' and buckets the alive 'discs' into it using 'pool'.
+
+The CSR arrays are filled with a two pass counting sort:  count the discs registered in each
+cell, prefix sum the cell capacities (capacityFor the count) into cellStart_ and then scatter
+the disc indices into cellDiscs_.  Cell occupancy is unbounded and memory is proportional to
+the number of disc registrations.
+
+The discs are split into contiguous blocks, one per pool thread.  Each block counts into its
+own cell histogram, the histograms are merged by a parallel prefix sum into per block write
+cursors and each block then scatters without locks.  A cell lists its discs in increasing
+index order whatever the number of blocks, so the grid (and every query result) does not
+depend on the thread count.
+*/
+void UniformGrid::build (const SceneDescription& scene, const DiscSet& discs, ThreadPool& pool)
+    {
+    build(scene,chooseCellSize(scene),discs,0,0,pool);
+    }
+
+/**
+\brief 'build' sizes the grid for the field of 'scene' with cells of size 'cellSize' and
+buckets into it the alive 'discs' i whose levels[i] is 'level', or all of them if 'levels'
+is 0.  This is how HierarchicalGrid builds its levels.
+*/
+void UniformGrid::build (const SceneDescription& scene, int cellSize, const DiscSet& discs,
+	const unsigned char* levels, int level, ThreadPool& pool)
+    {
+    origin_[0]=scene.field[0][0];
+    origin_[1]=scene.field[0][1];
+    cellWidth_=cellHeight_=cellSize;
+    columns_=(int)ceil((scene.field[1][0]-scene.field[0][0])/cellWidth_);
+    rows_=(int)ceil((scene.field[1][1]-scene.field[0][1])/cellHeight_);
+
+    const int noCells=cellCount();
+    const int noDiscs=discs.size();
+    const float* x=discs.x();
+    const float* y=discs.y();
+    const float* radius=discs.radius();
+    const unsigned char* alive=discs.alive();
+    // registered discs
+    auto member=[&](int i) {return alive[i] && (!levels || levels[i]==level);};
+
+    /* one block per thread, but keep the histograms within a small multiple of the grid
+       and disc arrays themselves and don't bother splitting small disc sets */
+    int blocks=pool.size();
+    blocks=min(blocks,max(1,noDiscs/MIN_BUILD_BLOCK_DISCS));
+    blocks=min(blocks,max(1,(int)(8*((long long)noDiscs+noCells)/max(noCells,1))));
+
+    /* cell histograms per block, later turned into per block write cursors */
+    vector< vector<int> > cursor(blocks);
+    cellStart_.assign(noCells,0);
+    cellNoDiscs_.assign(noCells,0);
+    cellCapacity_.assign(noCells,0);
+    abandoned_=0;
+
+	//pass 1: count the discs registered in each cell
+    pool.run(blocks,[&](int b, int)
+	{
+	vector<int>& histogram=cursor[b];
+	histogram.assign(noCells,0);
+	for(int i=blockBegin(b,blocks,noDiscs);i<blockBegin(b+1,blocks,noDiscs);i++)
+	    if(member(i))
+		forEachDiscCell(x[i],y[i],radius[i],[&](int c) {histogram[c]++;});
+	});
+
+	//merge: total count per cell, then an exclusive prefix sum over cells gives each
+	//cell's offset into cellDiscs_ and each block's write cursor within the cell
+    const int chunks=min(noCells,pool.size()*4);
+    vector<long long> chunkTotal(chunks+1,0);
+    pool.run(chunks,[&](int k, int)
+	{
+	long long total=0;
+	for(int c=blockBegin(k,chunks,noCells);c<blockBegin(k+1,chunks,noCells);c++)
+	    {
+	    int count=0;
+	    for(int b=0;b<blocks;b++)
+		count+=cursor[b][c];
+	    cellNoDiscs_[c]=count;
+	    cellCapacity_[c]=capacityFor(count);
+	    total+=cellCapacity_[c];
+	    }
+	chunkTotal[k+1]=total;
+	});
+    for(int k=0;k<chunks;k++)
+	chunkTotal[k+1]+=chunkTotal[k];
+    pool.run(chunks,[&](int k, int)
+	{
+	int start=(int)chunkTotal[k];
+	for(int c=blockBegin(k,chunks,noCells);c<blockBegin(k+1,chunks,noCells);c++)
+	    {
+	    cellStart_[c]=start;
+	    for(int b=0;b<blocks;b++)
+		{
+		int count=cursor[b][c];
+		cursor[b][c]=start;
+		start+=count;
+		}
+	    start=cellStart_[c] + cellCapacity_[c];
+	    }
+	});
+    cellDiscs_.assign((size_t)chunkTotal[chunks],0);
+
+	//pass 2: scatter the disc indices
+    pool.run(blocks,[&](int b, int)
+	{
+	vector<int>& next=cursor[b];
+	for(int i=blockBegin(b,blocks,noDiscs);i<blockBegin(b+1,blocks,noDiscs);i++)
+	    if(member(i))
+		forEachDiscCell(x[i],y[i],radius[i],[&](int c) {cellDiscs_[next[c]++]=i;});
+	});
+    }
+
+/**
+\brief 'insertInCell' appends disc 'id' to cell 'c', moving the cell to the end of cellDiscs_
+with twice the capacity if it is full.
+*/
+void UniformGrid::insertInCell (int c, int id)
+    {
+    if (cellNoDiscs_[c] == cellCapacity_[c])
+	{
+	const int start=(int)cellDiscs_.size();
+	const int capacity=max(2*cellCapacity_[c],4);
+	cellDiscs_.resize(start + capacity);
+	copy(cellDiscs_.begin() + cellStart_[c],cellDiscs_.begin() + cellStart_[c] + cellNoDiscs_[c],
+	    cellDiscs_.begin() + start);
+	abandoned_+=cellCapacity_[c];
+	cellStart_[c]=start;
+	cellCapacity_[c]=capacity;
+	}
+    cellDiscs_[cellStart_[c] + cellNoDiscs_[c]++]=id;
+    }
+
+/**
+\brief 'removeFromCell' drops disc 'id' from cell 'c'; the cell's last disc takes its place.
+*/
+void UniformGrid::removeFromCell (int c, int id)
+    {
+    int* cell=&cellDiscs_[0] + cellStart_[c];
+    int& n=cellNoDiscs_[c];
+    for(int j=0;j<n;j++)
+	if(cell[j]==id)
+	    {
+	    cell[j]=cell[--n];
+	    return;
+	    }
+    }
+
+/**
+\brief 'pack' lays the cells out again in order with capacityFor their counts, dropping the
+abandoned runs.
+*/
+void UniformGrid::pack ()
+    {
+    vector<int> packed;
+    long long total=0;
+    for(int c=0;c<cellCount();c++)
+	total+=capacityFor(cellNoDiscs_[c]);
+    packed.resize((size_t)total);
+    int start=0;
+    for(int c=0;c<cellCount();c++)
+	{
+	copy(cellDiscs_.begin() + cellStart_[c],cellDiscs_.begin() + cellStart_[c] + cellNoDiscs_[c],
+	    packed.begin() + start);
+	cellStart_[c]=start;
+	cellCapacity_[c]=capacityFor(cellNoDiscs_[c]);
+	start+=cellCapacity_[c];
+	}
+    cellDiscs_.swap(packed);
+    abandoned_=0;
+    }
+
+/**
+\brief 'insert' registers disc 'id', of radius 'radius' centred at (x,y), in every cell it
+overlaps.
+*/
+void UniformGrid::insert (int id, float x, float y, float radius)
+    {
+    forEachDiscCell(x,y,radius,[&](int c) {insertInCell(c,id);});
+    if (abandoned_ > (int)(cellDiscs_.size()/2))
+	pack();
+    }
+
+/**
+\brief 'remove' drops disc 'id', of radius 'radius' centred at (x,y), from every cell it is
+registered in.
+*/
+void UniformGrid::remove (int id, float x, float y, float radius)
+    {
+    forEachDiscCell(x,y,radius,[&](int c) {removeFromCell(c,id);});
+    }
+
+/**
+\brief 'move' re-registers disc 'id' of radius 'radius' after it moved from (oldX,oldY) to
+(x,y).  Only the cells it left or entered are touched:  both cell lists come out of
+forEachDiscCell in increasing order, so a merge finds the difference.
+*/
+void UniformGrid::move (int id, float oldX, float oldY, float x, float y, float radius)
+    {
+    CellList oldCells, newCells;
+    forEachDiscCell(oldX,oldY,radius,[&](int c) {oldCells.push_back(c);});
+    forEachDiscCell(x,y,radius,[&](int c) {newCells.push_back(c);});
+
+    const int noOld=oldCells.size(), noNew=newCells.size();
+    int i=0, j=0;
+    while(i<noOld || j<noNew)
+	{
+	if(j==noNew || (i<noOld && oldCells[i]<newCells[j]))
+	    removeFromCell(oldCells[i++],id);
+	else if(i==noOld || newCells[j]<oldCells[i])
+	    insertInCell(newCells[j++],id);
+	else
+	    {
+	    i++;
+	    j++;
+	    }
+	}
+    if (abandoned_ > (int)(cellDiscs_.size()/2))
+	pack();
+    }
+
+/**
+\brief 'selectBoxCells' stores in 'cells' every cell that overlaps 'box', row by row from the
+bottom and left to right within a row.  Each cell is stored once.
+
+The box is rasterised by scanline spans: for every grid row its edges are clipped to the
+row's strip and the x extent of the clipped edges, which is the extent of the box within
+the strip, gives the run of columns.
+*/
+void UniformGrid::selectBoxCells (const SweptBox& box, vector<int>& cells) const
+    {
+    float corner[4][2];
+    for (int i=0;i<4;i++)
+	box.corner(i,corner[i]);
+    float yMin=corner[0][1], yMax=corner[0][1];
+    for (int i=1;i<4;i++)
+	{
+	yMin=min(yMin,corner[i][1]);
+	yMax=max(yMax,corner[i][1]);
+	}
+
+    cells.clear();
+    for (int gy=cellRow(yMin);gy<=cellRow(yMax);gy++)
+	{
+	const float s0=max(yMin,(float)cellY(gy));
+	const float s1=min(yMax,(float)cellY(gy) + cellHeight_);
+	if (s0 > s1)
+	    continue;
+	float xMin=HUGE_VAL, xMax=-HUGE_VAL;
+	for (int i=0;i<4;i++)
+	    {
+	    const float* a=corner[i];
+	    const float* b=corner[(i+1)%4];
+	    const float lo=min(a[1],b[1]), hi=max(a[1],b[1]);
+	    if (hi < s0 || lo > s1)
+		continue;
+	    if (lo == hi)
+		{
+		xMin=min(xMin,min(a[0],b[0]));
+		xMax=max(xMax,max(a[0],b[0]));
+		continue;
+		}
+	    const float slope=(b[0]-a[0])/(b[1]-a[1]);
+	    const float xLo=a[0] + (max(lo,s0)-a[1])*slope;
+	    const float xHi=a[0] + (min(hi,s1)-a[1])*slope;
+	    xMin=min(xMin,min(xLo,xHi));
+	    xMax=max(xMax,max(xLo,xHi));
+	    }
+	for (int gx=cellColumn(xMin);gx<=cellColumn(xMax);gx++)
+	    cells.push_back(cellIndex(gx,gy));
+	}
+    }
+
+/**
+\brief 'selectIntersectedCells' walks the cells crossed by the segment (p1x,p1y)-(p2x,p2y) with
+a modified Bresenham midpoint line algorithm and appends each visited cell to 'cells'.
+
+The positive slope cases step a whole cell at a time.  The negative slope cases step one world
+unit at a time, so they append the same cell many times.
+*/
+void UniformGrid::selectIntersectedCells(int p1x, int p1y, int p2x, int p2y, std::vector<int>& cells) const
+{
+    int F, x, y;
+    CellVisitor visit(*this,cells);
+
+    if (p1x > p2x)  // Swap points if p1 is on the right of p2
+    {
+        swap(p1x, p2x);
+        swap(p1y, p2y);
+    }
+
+    // Handle trivial cases separately
+    //case 1: Vertical line
+    if (p1x == p2x)
+    {
+        if (p1y > p2y)  // Swap y-coordinates if p1 is above p2
+        {
+            swap(p1y, p2y);
+        }
+
+        x = p1x;
+        y = p1y;
+        while (y <= p2y)
+        {
+            visit(x, y);
+            y++;
+        }
+        return;
+    }
+    // Horizontal line
+    else if (p1y == p2y)
+    {
+        x = p1x;
+        y = p1y;
+
+        while (x <= p2x)
+        {
+            visit(x, y);
+            x++;
+        }
+        return;
+    }
+
+    int dy            = p2y - p1y;  // y-increment from p1 to p2
+    int dx            = p2x - p1x;  // x-increment from p1 to p2
+
+    if (dy >= 0)    // m >= 0
+    {
+        // Case 1: 0 <= m <= 1 (Original case)
+        if (dy <= dx)   
+        {
+            F = dy - dx;    // initial F
+
+            x = p1x;
+            y = p1y;
+            while (x < p2x)
+            {
+		//x++;
+		//y++;
+                 visit(x, y);
+
+
+                if (F > 0)
+                {   
+		    y+=cellHeight_;
+                    F = F - dx;
+                }
+                else if(F < 0)
+                {
+                    x+=cellWidth_;
+                    F = F + dy;
+                }
+		else
+                {
+                    y+=cellHeight_;
+		    x+=cellWidth_;
+                    F = F + dy - dx;
+                }
+		
+            }
+        }
+        // Case 2: 1 < m < INF (Mirror about y=x line
+        // replace all dy by dx and dx by dy)
+        else
+        {
+            F = dx - dy;    // initial F
+
+            y = p1y;
+            x = p1x;
+            while (y < p2y)
+            {
+                 visit(x, y);
+                if (F > 0)
+                {
+		    x+=cellWidth_;
+                    F -= dy;
+                }
+               else if(F<0)
+                {
+                    y+=cellHeight_;
+                    F += dx;
+                }
+                else
+		    {
+		    x+=cellWidth_;
+		    y+=cellHeight_;
+		    F = F + dx - dy;
+		    }
+            }
+        }
+    }
+    else    // m < 0
+    {
+        // Case 3: -1 <= m < 0 (Mirror about x-axis, replace all dy by -dy)
+        if (dx >= -dy)
+        {
+            F = -dy - dx;    // initial F
+
+            x = p1x;
+            y = p1y;
+            while (x < p2x)
+            {
+		//setPixel(x, y);
+                if (F < 0)
+                {
+		    x+=1;
+		     visit(x, y);
+                    F = F - dy;
+                }
+                else if(F>0)
+                {
+                    y-=1;
+		     visit(x, y);
+                    F = F - dx;
+                }
+		else
+		{
+		    
+		    x+=1;
+		    y-=1;
+		    if((x-cellX(0))%cellWidth_!=0 && (y-cellY(0))%cellHeight_!=0)
+			 visit(x, y);
+		    F = F - dy - dx;
+		}
+		
+            }
+        }
+        // Case 4: -INF < m < -1 (Mirror about x-axis and mirror 
+        // about y=x line, replace all dx by -dy and dy by dx)
+        else    
+        {
+            F = dx + dy;    // initial F
+
+            y = p1y;
+            x = p1x;
+            while (y > p2y)
+            {
+	        //setPixel(x,y);
+                if (F < 0)
+                {
+		    y-=1;
+		      visit(x, y);
+                    F += dx;
+                }
+                else if(F>0)
+                {
+                    x+=1;
+		      visit(x, y);
+                    F += dy;
+                }
+		else
+		{
+		 visit(x, y);
+                y-=1;
+		x+=1;
+		
+		F = F + dy + dx;
+		}
+		
+            }
+
+        }
+    }
+}
+
+/**
+\brief 'traverseCells' stores in 'cells' the cells crossed by segment (x1,y1)-(x2,y2), in order
+from (x1,y1), each once.  A cell is crossed if it holds a point of the segment, cells being
+half-open as in cellColumn and cellRow.
+
+This is the Amanatides-Woo grid traversal.  The segment is first clipped to the grid.  At
+each step the walk crosses the nearer of the next vertical and horizontal cell boundaries.
+Their distances along the segment, tMaxX and tMaxY, are kept in double scaled by the
+segment's extent along both axes, so they advance by whole cells, tDeltaX and tDeltaY,
+without a division and stay exact for coordinates of moderate precision.  A segment passing
+exactly through a cell corner is thus seen to do so; the walk then steps diagonally and also
+reports the cell holding the corner if it is neither the cell left nor the cell entered.  The number of steps is
+fixed by the end cell, so rounding can never make the walk overshoot it.
+*/
+void UniformGrid::traverseCells (float x1, float y1, float x2, float y2, vector<int>& cells) const
+    {
+    cells.clear();
+    if (columns_ == 0 || rows_ == 0)
+	return;
+
+    // Liang-Barsky clip to the grid rectangle, noting the boundary each end is clipped to
+    const double p[2]={x1,y1};
+    const double d[2]={(double)x2-x1,(double)y2-y1};
+    const double lo[2]={origin_[0],origin_[1]};
+    const double hi[2]={origin_[0] + (double)columns_*cellWidth_,origin_[1] + (double)rows_*cellHeight_};
+    double t0=0, t1=1;
+    int axis0=-1, axis1=-1;
+    for (int axis=0;axis<2;axis++)
+	{
+	if (d[axis] == 0)
+	    {
+	    if (p[axis] < lo[axis] || p[axis] > hi[axis])
+		return;
+	    continue;
+	    }
+	const double enter= d[axis]>0 ? lo[axis] : hi[axis];
+	const double leave= d[axis]>0 ? hi[axis] : lo[axis];
+	const double ta=(enter-p[axis])/d[axis], tb=(leave-p[axis])/d[axis];
+	if (ta > t0)
+	    {
+	    t0=ta;
+	    axis0=axis;
+	    }
+	if (tb < t1)
+	    {
+	    t1=tb;
+	    axis1=axis;
+	    }
+	}
+    if (t0 > t1)
+	return;
+
+    /* clipped end points:  the clipped coordinate is the boundary itself and the other one is
+       found from it, so an end exactly on a cell boundary stays on it */
+    double start[2]={x1,y1}, end[2]={x2,y2};
+    if (axis0 >= 0)
+	{
+	start[axis0]= d[axis0]>0 ? lo[axis0] : hi[axis0];
+	start[1-axis0]=p[1-axis0] + (start[axis0]-p[axis0])*d[1-axis0]/d[axis0];
+	}
+    if (axis1 >= 0)
+	{
+	end[axis1]= d[axis1]>0 ? hi[axis1] : lo[axis1];
+	end[1-axis1]=p[1-axis1] + (end[axis1]-p[axis1])*d[1-axis1]/d[axis1];
+	}
+
+    int gx=cellColumn((float)start[0]), gy=cellRow((float)start[1]);
+    const int endX=cellColumn((float)end[0]), endY=cellRow((float)end[1]);
+    const int stepX= d[0]>0 ? 1 : -1, stepY= d[1]>0 ? 1 : -1;
+    /* distances from (x1,y1) to the next vertical and horizontal boundary, each scaled by the
+       other axis' extent:  the smaller one is crossed first */
+    const double tDeltaX=cellWidth_*fabs(d[1]), tDeltaY=cellHeight_*fabs(d[0]);
+    double tMaxX=fabs(cellX(gx + (d[0]>0))-p[0])*fabs(d[1]);
+    double tMaxY=fabs(cellY(gy + (d[1]>0))-p[1])*fabs(d[0]);
+
+    int stepsX=abs(endX-gx), stepsY=abs(endY-gy);
+    cells.push_back(cellIndex(gx,gy));
+    while (stepsX > 0 || stepsY > 0)
+	{
+	if (stepsY == 0 || (stepsX > 0 && tMaxX < tMaxY))
+	    {
+	    gx+=stepX; tMaxX+=tDeltaX; stepsX--;
+	    }
+	else if (stepsX == 0 || tMaxY < tMaxX)
+	    {
+	    gy+=stepY; tMaxY+=tDeltaY; stepsY--;
+	    }
+	else
+	    {
+	    // through a corner:  it belongs to the cell it is the lower left corner of, which is
+	    // neither the cell left nor the cell entered on a step down-right or up-left
+	    if (stepX != stepY)
+		cells.push_back(cellIndex(stepX>0 ? gx+1 : gx,stepY>0 ? gy+1 : gy));
+	    gx+=stepX; tMaxX+=tDeltaX; stepsX--;
+	    gy+=stepY; tMaxY+=tDeltaY; stepsY--;
+	    }
+	cells.push_back(cellIndex(gx,gy));
+	}
+    }
+
+/**
+\brief 'selectSegmentCells' stores in 'cells' the cells crossed by segment (x1,y1)-(x2,y2)
+as listed by the walker 'traversal'.  The Bresenham walker gets the end points rounded to
+integers.
+*/
+void UniformGrid::selectSegmentCells (float x1, float y1, float x2, float y2, Traversal traversal, vector<int>& cells) const
+    {
+    if (traversal == TRAVERSAL_DDA)
+	{
+	traverseCells(x1,y1,x2,y2,cells);
+	return;
+	}
+    cells.clear();
+    selectIntersectedCells((int)floor(x1 + 0.5f),(int)floor(y1 + 0.5f),(int)floor(x2 + 0.5f),(int)floor(y2 + 0.5f),cells);
+    }
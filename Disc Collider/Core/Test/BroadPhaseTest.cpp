@@ -0,0 +1,143 @@
+/**
+\file BroadPhaseTest.cpp
+\brief BroadPhaseTest.cpp checks Collider::findAllPairs against testing every pair of discs,
+serially and in parallel with every backend, on random scenes and on scenes of discs that
+exactly touch on cell edges and corners.
+*/
+#include <DiscCollide/Collider.h>
+
+#include <algorithm>
+#include <stdlib.h>
+#include <vector>
+
+#include "Check.h"
+
+using namespace std;
+using namespace ITCS4120::DiscCollide;
+
+/*******************************************************************************
+    File Scope Functions
+*******************************************************************************/
+namespace ITCS4120
+{
+namespace DiscCollide
+{
+/* pair comparisons for sorting and comparing pair lists, found by argument dependent lookup */
+bool operator< (const DiscPair& p, const DiscPair& q)
+    {
+    return p.a < q.a || (p.a == q.a && p.b < q.b);
+    }
+
+bool operator== (const DiscPair& p, const DiscPair& q)
+    {
+    return p.a == q.a && p.b == q.b;
+    }
+};
+};
+
+namespace
+{
+/** \brief 'bruteForcePairs' returns every pair of alive 'discs' that overlap or touch, in order */
+vector<DiscPair> bruteForcePairs (const DiscSet& discs)
+    {
+    vector<DiscPair> pairs;
+    for (int a=0;a<discs.size();a++)
+	for (int b=a + 1;b<discs.size();b++)
+	    {
+	    if (!discs.alive()[a] || !discs.alive()[b])
+		continue;
+	    const float dx=discs.x()[b] - discs.x()[a], dy=discs.y()[b] - discs.y()[a];
+	    const float r=discs.radius()[a] + discs.radius()[b];
+	    if (dx*dx + dy*dy <= r*r)
+		{
+		const DiscPair pair={a,b};
+		pairs.push_back(pair);
+		}
+	    }
+    return pairs;
+    }
+
+/** \brief 'check' compares the pairs every backend finds in 'discs' with bruteForcePairs */
+void check (const SceneDescription& scene, const DiscSet& discs, ThreadPool& pool, const char* layout)
+    {
+    const vector<DiscPair> expected=bruteForcePairs(discs);
+    const SpatialBackend backends[]={SPATIAL_GRID,SPATIAL_QUADTREE,SPATIAL_BVH};
+    for (int k=0;k<3;k++)
+	{
+	Collider collider(scene,backends[k],pool);
+	collider.setDiscs(discs);
+	vector<DiscPair> serial, parallel;
+	collider.findAllPairs(serial);
+	collider.findAllPairs(parallel,true);
+	/* the parallel search lists the pairs in the same order */
+	CHECK(serial == parallel);
+	sort(serial.begin(),serial.end());
+	CHECK(serial == expected);
+	if (serial != expected)
+	    cout << "   " << layout << " " << collider.index().name() << ": " << serial.size()
+		 << " pairs found of " << expected.size() << endl;
+	}
+    }
+
+/** \brief 'addTouching' adds discs of radii 'ra' and 'rb' touching at (x,y) along direction (dx,dy)/5 */
+void addTouching (DiscSet& discs, float x, float y, int dx, int dy, int ra, int rb)
+    {
+    discs.add(x - ra*dx/5.0f,y - ra*dy/5.0f,(float)ra,0);
+    discs.add(x + rb*dx/5.0f,y + rb*dy/5.0f,(float)rb,0);
+    }
+}
+
+/*******************************************************************************
+    Exported (extern) Functions
+*******************************************************************************/
+int main ()
+    {
+    ThreadPool pool(4);
+
+	// random scenes, of one disc size and of sizes that fill several grid levels
+    for (int seed=1;seed<=4;seed++)
+	{
+	const SceneDescription scene={{{0,0},{600,400}},2500,3,0,seed%2 ? 0 : 40};
+	DiscSet discs;
+	generateDiscs(scene,seed,discs);
+	for (int i=0;i<discs.size();i+=7)
+	    discs.remove(i);
+	check(scene,discs,pool,"random");
+	}
+
+    /* the touching layouts use cells of 8, with level 1 cells of 16 and so on */
+    const SceneDescription scene={{{0,0},{512,512}},0,1,8,64};
+
+	// lattices of discs touching their neighbours on cell edges, at cell centres and corners
+    for (int lattice=0;lattice<3;lattice++)
+	{
+	DiscSet discs;
+	const float offset= lattice == 0 ? 4.0f : (lattice == 1 ? 0.0f : 2.0f);
+	const float radius= lattice == 2 ? 2.0f : 4.0f;
+	const float step=2*radius;
+	for (float y=offset + 16;y < 496;y+=step)
+	    for (float x=offset + 16;x < 496;x+=step)
+		discs.add(x,y,radius,0);
+	check(scene,discs,pool,"lattice");
+	}
+
+	// pairs of many radii touching on cell edges and corners, in every direction
+    DiscSet discs;
+    srand(17);
+    const int directions[8][2]={{5,0},{0,5},{3,4},{4,3},{-3,4},{-4,3},{3,-4},{4,-3}};
+    for (int i=0;i<1500;i++)
+	{
+	const int* d=directions[rand()%8];
+	const int axisAligned=d[0] == 0 || d[1] == 0;
+	/* radii that keep the centres on whole units:  any for axis aligned pairs, multiples of 5
+	   otherwise, now and then large enough for a coarser level */
+	const int scale= axisAligned ? 1 : 5;
+	const int ra=scale*(rand()%10 ? 1 + rand()%3 : 4 + rand()%5);
+	const int rb=scale*(rand()%10 ? 1 + rand()%3 : 4 + rand()%5);
+	const float x=8.0f*(4 + rand()%57), y=(i%3 ? 8.0f : 1.0f)*(4 + rand()%57);
+	addTouching(discs,x,y,d[0],d[1],ra,rb);
+	}
+    check(scene,discs,pool,"touching");
+
+    return checkResult("BroadPhaseTest");
+    }
@@ -0,0 +1,35 @@
+/**
+\file Check.h
+\brief Check.h defines the CHECK macro used by the disccollide_core tests.
+
+Each test is a small program that returns 0 when every CHECK held; ctest runs them.
+*/
+#ifndef DISCCOLLIDE_TEST_CHECK_H
+#define DISCCOLLIDE_TEST_CHECK_H
+
+#include <iostream>
+
+/** number of failed checks of this test program */
+static int checkFailures = 0;
+
+/**
+\brief CHECK prints 'expression' and counts a failure if it is false, then carries on so a
+single run reports every failure.
+*/
+#define CHECK(expression)\
+    do {\
+    if (!(expression)) {\
+	std::cout << "FAILED: " << #expression << std::endl <<\
+	     "   File: " << __FILE__ << "  Line: " << __LINE__ << std::endl;\
+	checkFailures++;\
+	}\
+    } while (0)
+
+/** \brief 'checkResult' reports the outcome of test 'name' and returns its exit status */
+inline int checkResult (const char* name)
+    {
+    std::cout << name << ": " << (checkFailures ? "FAILED" : "passed") << std::endl;
+    return checkFailures ? 1 : 0;
+    }
+
+#endif
@@ -0,0 +1,99 @@
+/**
+\file CompactTest.cpp
+\brief CompactTest.cpp checks that removing discs from a Collider keeps the ids of the other
+discs, and that compactIfSparse renumbers them only when called, reporting the new ids.
+*/
+#include <DiscCollide/Collider.h>
+
+#include <algorithm>
+#include <stdlib.h>
+#include <vector>
+
+#include "Check.h"
+
+using namespace std;
+using namespace ITCS4120::DiscCollide;
+
+/*******************************************************************************
+    File Scope Functions
+*******************************************************************************/
+namespace
+{
+/** \brief 'sorted' returns 'ids' in increasing order */
+vector<int> sorted (vector<int> ids)
+    {
+    sort(ids.begin(),ids.end());
+    return ids;
+    }
+
+/** \brief 'remapped' returns the ids 'ids' mapped through 'newId', in increasing order */
+vector<int> remapped (const vector<int>& ids, const vector<int>& newId)
+    {
+    vector<int> result;
+    for (size_t i=0;i<ids.size();i++)
+	result.push_back(newId[ids[i]]);
+    return sorted(result);
+    }
+}
+
+/*******************************************************************************
+    Exported (extern) Functions
+*******************************************************************************/
+int main ()
+    {
+    const SceneDescription scene={{{0,0},{1000,1000}},6000,2,16,6};
+    const SpatialBackend backends[]={SPATIAL_GRID,SPATIAL_QUADTREE,SPATIAL_BVH};
+
+    for (int k=0;k<3;k++)
+	{
+	Collider collider(scene,backends[k]);
+	collider.generate(5);
+	const int size=collider.discs().size();
+	const vector<float> x(collider.discs().x(),collider.discs().x() + size);
+	srand(17);
+
+	/* remove well over a quarter of the discs, a few at a time, as the demo does */
+	vector<int> removed, newId;
+	for (int round=0;round<40;round++)
+	    {
+	    vector<int> ids;
+	    for (int i=0;i<60;i++)
+		ids.push_back(rand()%size);
+	    collider.removeDiscs(ids);
+	    removed.insert(removed.end(),ids.begin(),ids.end());
+	    /* nothing is renumbered behind the caller's back */
+	    CHECK(collider.discs().size() == size);
+	    }
+	removed=sorted(removed);
+	removed.erase(unique(removed.begin(),removed.end()),removed.end());
+	CHECK((int)removed.size() >= size/4);
+	CHECK(collider.discs().removedCount() == (int)removed.size());
+	for (int i=0;i<size;i++)
+	    CHECK(collider.discs().x()[i] == x[i]);
+
+	SweptBoxResult before;
+	collider.sweptBoxQuery(100,100,900,800,60,before);
+	for (size_t i=0;i<before.hits.size();i++)
+	    CHECK(!binary_search(removed.begin(),removed.end(),before.hits[i]));
+
+	/* the maintenance point drops the tombstones and maps every old id */
+	CHECK(collider.compactIfSparse(newId));
+	CHECK((int)newId.size() == size);
+	CHECK(collider.discs().size() == size - (int)removed.size());
+	CHECK(collider.discs().removedCount() == 0);
+	for (int i=0;i<size;i++)
+	    if (binary_search(removed.begin(),removed.end(),i))
+		CHECK(newId[i] == -1);
+	    else
+		CHECK(newId[i] >= 0 && collider.discs().x()[newId[i]] == x[i]);
+
+	SweptBoxResult after;
+	collider.sweptBoxQuery(100,100,900,800,60,after);
+	CHECK(remapped(before.hits,newId) == sorted(after.hits));
+
+	/* with no tombstones left there is nothing to do */
+	CHECK(!collider.compactIfSparse(newId));
+	}
+
+    return checkResult("CompactTest");
+    }
@@ -0,0 +1,130 @@
+/**
+\file GridUpdateTest.cpp
+\brief GridUpdateTest.cpp checks that a UniformGrid kept up to date by insert, remove and
+move holds, cell by cell, the same discs as a grid built afresh from the same discs.
+*/
+#include <DiscCollide/UniformGrid.h>
+
+#include <algorithm>
+#include <stdlib.h>
+#include <vector>
+
+#include "Check.h"
+
+using namespace std;
+using namespace ITCS4120::DiscCollide;
+
+/*******************************************************************************
+    File Scope Functions
+*******************************************************************************/
+namespace
+{
+float random (float lo, float hi)
+    {
+    return lo + (hi - lo)*(rand()/(float)RAND_MAX);
+    }
+
+/** \brief 'radius' draws a disc radius, mostly below a cell but now and then many cells wide */
+float radius ()
+    {
+    return rand()%20 ? random(0.5f,12) : random(12,80);
+    }
+
+/** \brief 'check' compares every cell of 'patched' with the same cell of a grid built from 'discs' */
+void check (const UniformGrid& patched, const SceneDescription& scene, const DiscSet& discs)
+    {
+    UniformGrid built;
+    built.build(scene,discs);
+    CHECK(patched.cellCount() == built.cellCount());
+    int differ=0;
+    for (int c=0;c<built.cellCount();c++)
+	{
+	vector<int> a(patched.cellDiscs(c),patched.cellDiscs(c) + patched.cellNoDiscs(c));
+	vector<int> b(built.cellDiscs(c),built.cellDiscs(c) + built.cellNoDiscs(c));
+	sort(a.begin(),a.end());
+	if (a != b)
+	    differ++;
+	}
+    CHECK(differ == 0);
+    }
+}
+
+/*******************************************************************************
+    Exported (extern) Functions
+*******************************************************************************/
+int main ()
+    {
+    /* the field is 13 x 9 cells of 16, the last column and row only partly covered by it */
+    SceneDescription scene={{{-50,20},{150,160}},0,1,16};
+    const float lo[2]={-80,-10}, hi[2]={180,190};
+    srand(11);
+
+    DiscSet discs;
+    for (int i=0;i<400;i++)
+	discs.add(random(lo[0],hi[0]),random(lo[1],hi[1]),radius(),0);
+    UniformGrid grid;
+    grid.build(scene,discs);
+    check(grid,scene,discs);
+
+    for (int round=0;round<50;round++)
+	{
+	for (int k=0;k<400;k++)
+	    {
+	    const int op=rand()%10;
+	    const int id=rand()%discs.size();
+	    if (op < 6)
+		{
+		/* move, mostly by a little, now and then across the field or onto a cell edge */
+		if (!discs.alive()[id])
+		    continue;
+		float& x=discs.x()[id];
+		float& y=discs.y()[id];
+		const float oldX=x, oldY=y;
+		if (op == 0)
+		    {
+		    x=random(lo[0],hi[0]);
+		    y=random(lo[1],hi[1]);
+		    }
+		else if (op == 1)
+		    {
+		    x=(float)(-50 + 16*(rand()%14));
+		    y=(float)(20 + 16*(rand()%10));
+		    }
+		else
+		    {
+		    x+=random(-6,6);
+		    y+=random(-6,6);
+		    }
+		grid.move(id,oldX,oldY,x,y,discs.radius()[id]);
+		}
+	    else if (op < 8)
+		{
+		if (!discs.alive()[id])
+		    continue;
+		grid.remove(id,discs.x()[id],discs.y()[id],discs.radius()[id]);
+		discs.remove(id);
+		}
+	    else
+		{
+		const int added=discs.add(random(lo[0],hi[0]),random(lo[1],hi[1]),radius(),0);
+		grid.insert(added,discs.x()[added],discs.y()[added],discs.radius()[added]);
+		}
+	    }
+	check(grid,scene,discs);
+	}
+
+	// a crowd moving into one cell makes it outgrow its run many times over
+    for (int id=0;id<discs.size();id++)
+	if (discs.alive()[id])
+	    {
+	    float& x=discs.x()[id];
+	    float& y=discs.y()[id];
+	    const float oldX=x, oldY=y;
+	    x=random(0,15);
+	    y=random(40,55);
+	    grid.move(id,oldX,oldY,x,y,discs.radius()[id]);
+	    }
+    check(grid,scene,discs);
+
+    return checkResult("GridUpdateTest");
+    }
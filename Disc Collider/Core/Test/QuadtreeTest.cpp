@@ -0,0 +1,128 @@
+/**
+\file QuadtreeTest.cpp
+\brief QuadtreeTest.cpp checks that a LooseQuadtree kept up to date by insert, remove and move
+returns every disc a box query hits, and every registered disc exactly once, while its nodes
+split, merge and move their discs between runs.
+*/
+#include <DiscCollide/LooseQuadtree.h>
+#include <DiscCollide/SegmentKernel.h>
+
+#include <algorithm>
+#include <stdlib.h>
+#include <vector>
+
+#include "Check.h"
+
+using namespace std;
+using namespace ITCS4120::DiscCollide;
+
+/*******************************************************************************
+    File Scope Functions
+*******************************************************************************/
+namespace
+{
+float random (float lo, float hi)
+    {
+    return lo + (hi - lo)*(rand()/(float)RAND_MAX);
+    }
+
+/** \brief a coordinate crowded around 'centre' for 3 of 4 discs, so the nodes there split deep */
+float clustered (float centre)
+    {
+    return rand()%4 ? centre + random(-20,20) : random(0,1024);
+    }
+
+/** \brief mostly small radii, with a few discs large enough to stay near the root */
+float radius ()
+    {
+    return rand()%50 ? random(0.5f,3) : random(20,300);
+    }
+
+/**
+\brief 'check' compares the candidates of 'tree' for 'box' with the discs of 'discs' the box
+hits, and returns the candidates.  Every hit must be a candidate and no candidate may repeat
+or be a removed disc.
+*/
+vector<int> check (const LooseQuadtree& tree, const DiscSet& discs, const SweptBox& box)
+    {
+    vector<int> cells, candidates;
+    tree.boxCandidates(box,cells,candidates);
+    sort(candidates.begin(),candidates.end());
+    CHECK(unique(candidates.begin(),candidates.end()) == candidates.end());
+
+    vector<unsigned> mask(hitMaskWords(discs.size()) + 1);
+    boxHits(box,discs.x(),discs.y(),discs.radius(),0,discs.size(),&mask[0]);
+    int missed=0;
+    for (int i=0;i<discs.size();i++)
+	{
+	if (!discs.alive()[i])
+	    CHECK(!binary_search(candidates.begin(),candidates.end(),i));
+	else if (mask[i/32] & (1u << i%32) && !binary_search(candidates.begin(),candidates.end(),i))
+	    missed++;
+	}
+    CHECK(missed == 0);
+    return candidates;
+    }
+}
+
+/*******************************************************************************
+    Exported (extern) Functions
+*******************************************************************************/
+int main ()
+    {
+    const SceneDescription scene={{{0,0},{1024,1024}},0,1,8,0};
+    DiscSet discs;
+    srand(19);
+    for (int i=0;i<3000;i++)
+	discs.add(clustered(300),clustered(700),radius(),0);
+    LooseQuadtree tree;
+    tree.build(scene,discs);
+    CHECK(tree.depth() > 4);
+
+    for (int round=0;round<60;round++)
+	{
+	/* small steps keep most discs in their nodes, jumps move them across the tree */
+	for (int k=0;k<300;k++)
+	    {
+	    const int id=rand()%discs.size();
+	    if (!discs.alive()[id])
+		continue;
+	    const float step= k%3 ? 2.0f : 600.0f;
+	    const float x=discs.x()[id] + random(-step,step), y=discs.y()[id] + random(-step,step);
+	    tree.move(id,discs.x()[id],discs.y()[id],x,y,discs.radius()[id]);
+	    discs.x()[id]=x;
+	    discs.y()[id]=y;
+	    }
+	/* empty whole clusters some rounds, so that nodes merge, and refill them on others */
+	const int removals= round%10 < 5 ? 400 : 50;
+	for (int k=0;k<removals;k++)
+	    {
+	    const int id=rand()%discs.size();
+	    if (!discs.alive()[id])
+		continue;
+	    tree.remove(id,discs.x()[id],discs.y()[id],discs.radius()[id]);
+	    discs.remove(id);
+	    }
+	const int additions= round%10 < 5 ? 50 : 400;
+	for (int k=0;k<additions;k++)
+	    {
+	    const float x=clustered(round%2 ? 300.0f : 800.0f), y=clustered(500), r=radius();
+	    const int id=discs.add(x,y,r,0);
+	    tree.insert(id,x,y,r);
+	    }
+
+	for (int q=0;q<20;q++)
+	    check(tree,discs,SweptBox(random(0,1024),random(0,1024),random(0,1024),random(0,1024),random(0,30)));
+	/* a box over the whole field returns every registered disc, once */
+	const vector<int> all=check(tree,discs,SweptBox(-400,512,1424,512,912));
+	CHECK((int)all.size() == discs.size() - discs.removedCount());
+	}
+
+    /* with every disc removed the tree merges back into its root */
+    for (int i=0;i<discs.size();i++)
+	if (discs.alive()[i])
+	    tree.remove(i,discs.x()[i],discs.y()[i],discs.radius()[i]);
+    CHECK(tree.nodeCount() == 1 && tree.depth() == 0);
+
+    return checkResult("QuadtreeTest");
+    }
@@ -0,0 +1,112 @@
+/**
+\file SegmentKernelTest.cpp
+\brief SegmentKernelTest.cpp checks that every batch kernel this processor supports returns
+the masks of the scalar kernel, for batch sizes that leave partly filled vectors.
+*/
+#include <DiscCollide/SegmentKernel.h>
+
+#include <stdlib.h>
+#include <vector>
+
+#include "Check.h"
+
+using namespace std;
+using namespace ITCS4120::DiscCollide;
+
+/*******************************************************************************
+    File Scope Functions
+*******************************************************************************/
+namespace
+{
+float random (float lo, float hi)
+    {
+    return lo + (hi - lo)*(rand()/(float)RAND_MAX);
+    }
+
+/**
+\brief Batch is a batch of discs and the shapes tested against them.  With 'onGrid' the
+discs and shapes sit on integer coordinates, so many discs exactly touch a shape.
+*/
+struct Batch
+    {
+    vector<float> x, y, radius;
+    vector<int> ids;
+    float segment[4];
+    float box[5];
+
+    Batch (int trial, int n, bool onGrid)
+	{
+	const int discs=n + trial%5;
+	for (int i=0;i<discs;i++)
+	    {
+	    x.push_back(onGrid ? (float)(rand()%21) : random(0,100));
+	    y.push_back(onGrid ? (float)(rand()%21) : random(0,100));
+	    radius.push_back(onGrid ? (float)(1 + rand()%3) : random(0.5f,10));
+	    }
+	/* every other trial reads the discs through a shuffled id list */
+	if (trial%2)
+	    for (int i=0;i<n;i++)
+		ids.push_back(rand()%discs);
+	for (int k=0;k<4;k++)
+	    segment[k]=onGrid ? (float)(rand()%21) : random(0,100);
+	if (trial%7 == 0)
+	    {
+	    segment[2]=segment[0];
+	    segment[3]=segment[1];
+	    }
+	for (int k=0;k<4;k++)
+	    box[k]=segment[k];
+	box[4]=onGrid ? (float)(rand()%3) : random(0,8);
+	}
+
+    const int* idList () const {return ids.empty() ? 0 : &ids[0];}
+
+    vector<unsigned> segmentMask (int n) const
+	{
+	vector<unsigned> mask(hitMaskWords(n) + 1,0xDEADBEEF);
+	segmentHits(Segment(segment[0],segment[1],segment[2],segment[3]),&x[0],&y[0],&radius[0],
+	    idList(),n,&mask[0]);
+	return mask;
+	}
+
+    vector<unsigned> boxMask (int n) const
+	{
+	vector<unsigned> mask(hitMaskWords(n) + 1,0xDEADBEEF);
+	boxHits(SweptBox(box[0],box[1],box[2],box[3],box[4]),&x[0],&y[0],&radius[0],
+	    idList(),n,&mask[0]);
+	return mask;
+	}
+    };
+}
+
+/*******************************************************************************
+    Exported (extern) Functions
+*******************************************************************************/
+int main ()
+    {
+    const SegmentKernel kernels[]={SEGMENT_KERNEL_SSE2,SEGMENT_KERNEL_AVX2};
+    srand(5);
+    for (int trial=0;trial<600;trial++)
+	{
+	/* sizes 0 ... 67 cover empty batches and every tail length of 4 and 8 lanes */
+	const int n=trial%68;
+	const Batch batch(trial,n,trial%3 == 0);
+	setSegmentKernel(SEGMENT_KERNEL_SCALAR);
+	const vector<unsigned> segmentRef=batch.segmentMask(n), boxRef=batch.boxMask(n);
+	/* the word past the mask must be left alone */
+	CHECK(segmentRef.back() == 0xDEADBEEF && boxRef.back() == 0xDEADBEEF);
+	for (int k=0;k<2;k++)
+	    {
+	    if (setSegmentKernel(kernels[k]) != kernels[k])
+		continue;
+	    CHECK(batch.segmentMask(n) == segmentRef);
+	    CHECK(batch.boxMask(n) == boxRef);
+	    }
+	}
+
+    for (int k=0;k<2;k++)
+	cout << segmentKernelName(kernels[k])
+	     << (setSegmentKernel(kernels[k]) == kernels[k] ? " checked" : " not supported here") << endl;
+    setSegmentKernel(bestSegmentKernel());
+    return checkResult("SegmentKernelTest");
+    }
@@ -0,0 +1,95 @@
+/**
+\file SplitQueryTest.cpp
+\brief SplitQueryTest.cpp checks that long queries, which a Collider splits across its
+thread pool, hit the same discs as the same queries run serially.
+*/
+#include <DiscCollide/Collider.h>
+
+#include <algorithm>
+#include <math.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "Check.h"
+
+using namespace std;
+using namespace ITCS4120::DiscCollide;
+
+/*******************************************************************************
+    File Scope Functions
+*******************************************************************************/
+namespace
+{
+float random (float lo, float hi)
+    {
+    return lo + (hi - lo)*(rand()/(float)RAND_MAX);
+    }
+
+/** \brief 'sorted' returns 'ids' in increasing order, checking that none repeats */
+vector<int> sorted (vector<int> ids)
+    {
+    sort(ids.begin(),ids.end());
+    CHECK(unique(ids.begin(),ids.end()) == ids.end());
+    return ids;
+    }
+
+/** \brief 'includes' is true if every id of 'a' is in 'b' */
+bool includes (const vector<int>& b, const vector<int>& a)
+    {
+    const vector<int> sa=sorted(a), sb=sorted(b);
+    return std::includes(sb.begin(),sb.end(),sa.begin(),sa.end());
+    }
+}
+
+/*******************************************************************************
+    Exported (extern) Functions
+*******************************************************************************/
+int main ()
+    {
+    /* 1024 x 1024 cells of 8, so field-long queries are split into many pieces */
+    const SceneDescription scene={{{0,0},{8192,8192}},60000,2,8,6};
+    const SpatialBackend backends[]={SPATIAL_GRID,SPATIAL_QUADTREE,SPATIAL_BVH};
+    ThreadPool serialPool(1), parallelPool(max(8,(int)thread::hardware_concurrency()));
+
+    for (int k=0;k<3;k++)
+	{
+	Collider serial(scene,backends[k],serialPool), parallel(scene,backends[k],parallelPool);
+	serial.generate(3);
+	parallel.generate(3);
+	srand(13);
+	int split=0;
+	for (int q=0;q<300;q++)
+	    {
+	    float x1=random(0,8192), y1=random(0,8192), x2=random(0,8192), y2=random(0,8192);
+	    if (q%5 == 0)
+		{
+		/* diagonal through grid corners, or along a grid line */
+		x1=y1=8.0f*(rand()%64);
+		x2=y2=8192 - 8.0f*(rand()%64);
+		if (q%10 == 0)
+		    x2=x1;
+		}
+	    const float halfWidth= q%3 ? random(0,40) : 0;
+	    const float dx=x2-x1, dy=y2-y1;
+	    if (sqrtf(dx*dx + dy*dy) > 2*256*8)
+		split++;
+
+	    SweptBoxResult a, b;
+	    serial.sweptBoxQuery(x1,y1,x2,y2,halfWidth,a);
+	    parallel.sweptBoxQuery(x1,y1,x2,y2,halfWidth,b);
+	    CHECK(sorted(a.hits) == sorted(b.hits));
+	    /* the pieces' cells and candidates may differ in ones the query only touches, as
+	       the piece end points are rounded, but every hit must come from a candidate */
+	    CHECK(includes(b.candidates,b.hits));
+
+	    vector<int> serialHits, parallelHits;
+	    serial.segmentQuery(x1,y1,x2,y2,serialHits);
+	    parallel.segmentQuery(x1,y1,x2,y2,parallelHits);
+	    CHECK(sorted(serialHits) == sorted(parallelHits));
+	    }
+	/* most queries are long enough to be split */
+	CHECK(split > 150);
+	}
+
+    return checkResult("SplitQueryTest");
+    }
@@ -0,0 +1,141 @@
+/**
+\file SweepAndPruneTest.cpp
+\brief SweepAndPruneTest.cpp checks that a SweepAndPrune kept up to date by update, while the
+discs move, die and are added, finds the same box pairs and disc pairs as one built from
+scratch, and as testing every pair of discs.
+*/
+#include <DiscCollide/SweepAndPrune.h>
+
+#include <algorithm>
+#include <stdlib.h>
+#include <vector>
+
+#include "Check.h"
+
+using namespace std;
+using namespace ITCS4120::DiscCollide;
+
+/*******************************************************************************
+    File Scope Functions
+*******************************************************************************/
+namespace
+{
+float random (float lo, float hi)
+    {
+    return lo + (hi - lo)*(rand()/(float)RAND_MAX);
+    }
+
+/** \brief 'sorted' returns 'pairs' as a << 32 | b keys in increasing order */
+vector<unsigned long long> sorted (const vector<DiscPair>& pairs)
+    {
+    vector<unsigned long long> keys;
+    for (size_t i=0;i<pairs.size();i++)
+	keys.push_back((unsigned long long)pairs[i].a << 32 | (unsigned)pairs[i].b);
+    sort(keys.begin(),keys.end());
+    return keys;
+    }
+
+/** \brief 'bruteForcePairs' returns every pair of alive 'discs' that overlap or touch */
+vector<DiscPair> bruteForcePairs (const DiscSet& discs)
+    {
+    vector<DiscPair> pairs;
+    for (int a=0;a<discs.size();a++)
+	for (int b=a + 1;b<discs.size();b++)
+	    {
+	    if (!discs.alive()[a] || !discs.alive()[b])
+		continue;
+	    const float dx=discs.x()[b] - discs.x()[a], dy=discs.y()[b] - discs.y()[a];
+	    const float r=discs.radius()[a] + discs.radius()[b];
+	    if (dx*dx + dy*dy <= r*r)
+		{
+		const DiscPair pair={a,b};
+		pairs.push_back(pair);
+		}
+	    }
+    return pairs;
+    }
+
+/** \brief 'place' puts disc 'id' at a random spot, on whole units now and then so that boxes touch */
+void place (DiscSet& discs, int id)
+    {
+    if (rand()%3 == 0)
+	{
+	discs.x()[id]=(float)(rand()%200);
+	discs.y()[id]=(float)(rand()%200);
+	}
+    else
+	{
+	discs.x()[id]=random(0,200);
+	discs.y()[id]=random(0,200);
+	}
+    }
+
+/** \brief 'radius' draws a disc radius, a whole number a third of the time */
+float radius ()
+    {
+    return rand()%3 == 0 ? (float)(1 + rand()%6) : random(0.5f,6);
+    }
+}
+
+/*******************************************************************************
+    Exported (extern) Functions
+*******************************************************************************/
+int main ()
+    {
+    srand(19);
+    DiscSet discs;
+    for (int i=0;i<600;i++)
+	{
+	const int id=discs.add(0,0,radius(),0);
+	place(discs,id);
+	}
+    SweepAndPrune sap;
+    sap.build(discs);
+    int deadRounds=0;
+
+    for (int round=0;round<200;round++)
+	{
+	const int n=discs.size();
+	/* most rounds move a few discs a little; some move many, or far */
+	const int moves= round%10 == 0 ? n : 1 + rand()%40;
+	for (int k=0;k<moves;k++)
+	    {
+	    const int id=rand()%n;
+	    if (rand()%8 == 0)
+		place(discs,id);
+	    else
+		{
+		discs.x()[id]+=random(-3,3);
+		discs.y()[id]+=random(-3,3);
+		}
+	    if (rand()%20 == 0)
+		discs.radius()[id]=radius();
+	    }
+	/* removals leave dead discs with empty boxes; additions revive them first and only
+	   grow the set, which makes update rebuild, once none is left */
+	for (int k=rand()%6;k > 0;k--)
+	    discs.remove(rand()%n);
+	for (int k= round%25 == 24 ? discs.removedCount() + 3 : rand()%6;k > 0;k--)
+	    {
+	    const int id=discs.add(0,0,radius(),0);
+	    place(discs,id);
+	    }
+
+	if (discs.removedCount() > 0)
+	    deadRounds++;
+	sap.update(discs);
+	SweepAndPrune fresh;
+	fresh.build(discs);
+	CHECK(sap.boxPairs() == fresh.boxPairs());
+	vector<DiscPair> pairs, freshPairs;
+	sap.findPairs(discs,pairs);
+	fresh.findPairs(discs,freshPairs);
+	const vector<unsigned long long> keys=sorted(pairs);
+	CHECK(keys == sorted(freshPairs));
+	CHECK(keys == sorted(bruteForcePairs(discs)));
+	}
+    /* most updates saw dead discs */
+    CHECK(deadRounds > 100);
+
+    return checkResult("SweepAndPruneTest");
+    }
@@ -0,0 +1,124 @@
+/**
+\file ThreadPoolTest.cpp
+\brief ThreadPoolTest.cpp checks that ThreadPool::run runs every task exactly once, on a
+valid thread, for pools of one, two and many threads and for runs nested in a task.
+*/
+#include <DiscCollide/ThreadPool.h>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <memory>
+#include <vector>
+
+#include "Check.h"
+
+using namespace std;
+using namespace ITCS4120::DiscCollide;
+
+/*******************************************************************************
+    File Scope Functions
+*******************************************************************************/
+namespace
+{
+/**
+\brief 'runOnce' runs 'tasks' tasks on 'pool' and returns true if each ran once, and no two
+at the same time under the same thread index.
+*/
+bool runOnce (ThreadPool& pool, int tasks)
+    {
+    unique_ptr<atomic<int>[]> runs(new atomic<int>[max(tasks,1)]);
+    unique_ptr<atomic<int>[]> running(new atomic<int>[pool.size()]);
+    for (int i=0;i<tasks;i++)
+	runs[i]=0;
+    for (int t=0;t<pool.size();t++)
+	running[t]=0;
+    atomic<int> badThread(0), sharedThread(0);
+
+    pool.run(tasks,[&](int task, int thread)
+	{
+	if (thread < 0 || thread >= pool.size())
+	    {
+	    badThread++;
+	    return;
+	    }
+	/* no two tasks run at once under the same thread index */
+	if (running[thread]++ != 0)
+	    sharedThread++;
+	runs[task]++;
+	running[thread]--;
+	});
+
+    int wrong=0;
+    for (int i=0;i<tasks;i++)
+	if (runs[i] != 1)
+	    wrong++;
+    return wrong == 0 && badThread == 0 && sharedThread == 0;
+    }
+
+/**
+\brief 'nestedRunOnce' runs 'outer' tasks on 'pool' that each run 'inner' tasks on it and
+returns true if each inner task ran once.
+*/
+bool nestedRunOnce (ThreadPool& pool, int outer, int inner)
+    {
+    unique_ptr<atomic<int>[]> runs(new atomic<int>[outer*inner]);
+    for (int i=0;i<outer*inner;i++)
+	runs[i]=0;
+    atomic<int> badThread(0);
+
+    pool.run(outer,[&](int task, int)
+	{
+	pool.run(inner,[&](int subtask, int thread)
+	    {
+	    if (thread < 0 || thread >= pool.size())
+		badThread++;
+	    runs[task*inner + subtask]++;
+	    });
+	});
+
+    int wrong=0;
+    for (int i=0;i<outer*inner;i++)
+	if (runs[i] != 1)
+	    wrong++;
+    return wrong == 0 && badThread == 0;
+    }
+}
+
+/*******************************************************************************
+    Exported (extern) Functions
+*******************************************************************************/
+int main ()
+    {
+    const int many=max(8,(int)thread::hardware_concurrency());
+    const int sizes[]={1,2,many};
+    const int tasks[]={0,1,2,3,7,64,1000,100000};
+    for (int s=0;s<3;s++)
+	{
+	ThreadPool pool(sizes[s]);
+	CHECK(pool.size() == sizes[s]);
+	for (int repeat=0;repeat<20;repeat++)
+	    for (int t=0;t<8;t++)
+		CHECK(runOnce(pool,tasks[t]));
+	CHECK(nestedRunOnce(pool,1,50));
+	CHECK(nestedRunOnce(pool,37,50));
+	CHECK(nestedRunOnce(pool,500,3));
+	}
+
+    /* several threads calling run on the same pool at once */
+    ThreadPool pool(4);
+    atomic<int> failed(0);
+    vector<thread> callers;
+    for (int c=0;c<4;c++)
+	callers.push_back(thread([&]()
+	    {
+	    for (int i=0;i<50;i++)
+		if (!runOnce(pool,1000))
+		    failed++;
+	    }));
+    for (size_t c=0;c<callers.size();c++)
+	callers[c].join();
+    CHECK(failed == 0);
+
+    return checkResult("ThreadPoolTest");
+    }
@@ -0,0 +1,207 @@
+/**
+\file TraverseCellsTest.cpp
+\brief TraverseCellsTest.cpp checks the cells UniformGrid::traverseCells lists for a segment
+against testing the segment with every cell of the grid.
+
+Coordinates are multiples of 1/4 so that the brute force test can be done exactly in
+integers:  a cell is crossed if the segment holds a point of the half-open cell, the last
+column and row also owning the grid's right and top edges.
+*/
+#include <DiscCollide/UniformGrid.h>
+
+#include <algorithm>
+#include <stdlib.h>
+#include <vector>
+
+#include "Check.h"
+
+using namespace std;
+using namespace ITCS4120::DiscCollide;
+
+/*******************************************************************************
+    File Scope Data Types
+*******************************************************************************/
+namespace
+{
+/** subdivisions of a world unit used by the test coordinates */
+const int UNIT=4;
+/** grid of the test:  20 x 15 cells of 8 x 8 from (-40,-24) */
+const int CELL=8, COLUMNS=20, ROWS=15, ORIGIN_X=-40, ORIGIN_Y=-24;
+
+/**
+\brief Bound is a bound on the segment parameter t, n/d with d > 0, that is strict or not.
+*/
+struct Bound
+    {
+    long long n, d;
+    bool strict;
+    };
+
+/** \brief Interval is the set of segment parameters t between a lower and an upper Bound */
+struct Interval
+    {
+    Bound lo, hi;
+
+    Interval () {lo.n=0; lo.d=1; lo.strict=false; hi.n=1; hi.d=1; hi.strict=false;}
+
+    bool empty () const
+	{
+	const long long a=lo.n*hi.d, b=hi.n*lo.d;
+	return a > b || (a == b && (lo.strict || hi.strict));
+	}
+
+    /** \brief keep the t with p + t*dp >= v (> v if 'strict') */
+    void above (long long p, long long dp, long long v, bool strict)
+	{
+	if (dp == 0)
+	    {
+	    if (p < v || (strict && p == v))
+		hi.n=-1;
+	    return;
+	    }
+	if (dp > 0)
+	    {
+	    const Bound b={v-p,dp,strict};
+	    tighten(b,true);
+	    }
+	else
+	    {
+	    const Bound b={p-v,-dp,strict};
+	    tighten(b,false);
+	    }
+	}
+
+    /** \brief keep the t with p + t*dp <= v (< v if 'strict') */
+    void below (long long p, long long dp, long long v, bool strict)
+	{
+	above(-p,-dp,-v,strict);
+	}
+
+    private:
+    void tighten (const Bound& b, bool lower)
+	{
+	Bound& old= lower ? lo : hi;
+	const long long a=b.n*old.d, c=old.n*b.d;
+	if (lower ? a > c : a < c)
+	    old=b;
+	else if (a == c)
+	    old.strict=old.strict || b.strict;
+	}
+    };
+}
+
+/*******************************************************************************
+    File Scope Functions
+*******************************************************************************/
+namespace
+{
+/** \brief 'crossed' is the exact test of segment (x1,y1)-(x2,y2), in 1/UNIT, with cell (gx,gy) */
+bool crossed (long long x1, long long y1, long long x2, long long y2, int gx, int gy)
+    {
+    const long long left=(ORIGIN_X + gx*CELL)*UNIT, bottom=(ORIGIN_Y + gy*CELL)*UNIT;
+    Interval t;
+    t.above(x1,x2-x1,left,false);
+    t.below(x1,x2-x1,left + CELL*UNIT,gx < COLUMNS-1);
+    t.above(y1,y2-y1,bottom,false);
+    t.below(y1,y2-y1,bottom + CELL*UNIT,gy < ROWS-1);
+    return !t.empty();
+    }
+
+/** \brief 'check' compares traverseCells with 'crossed' for one segment, in 1/UNIT */
+void check (const UniformGrid& grid, int x1, int y1, int x2, int y2)
+    {
+    vector<int> cells;
+    grid.traverseCells((float)x1/UNIT,(float)y1/UNIT,(float)x2/UNIT,(float)y2/UNIT,cells);
+    vector<int> expected;
+    for (int gy=0;gy<ROWS;gy++)
+	for (int gx=0;gx<COLUMNS;gx++)
+	    if (crossed(x1,y1,x2,y2,gx,gy))
+		expected.push_back(grid.cellIndex(gx,gy));
+
+    vector<int> sorted(cells);
+    sort(sorted.begin(),sorted.end());
+    const bool once=unique(sorted.begin(),sorted.end()) == sorted.end();
+    CHECK(once);
+    CHECK(sorted == expected);
+    /* consecutive cells share an edge or a corner */
+    for (size_t i=1;i<cells.size();i++)
+	{
+	const int dx=abs(cells[i]%COLUMNS - cells[i-1]%COLUMNS), dy=abs(cells[i]/COLUMNS - cells[i-1]/COLUMNS);
+	CHECK(dx <= 1 && dy <= 1);
+	}
+    if (!once || sorted != expected)
+	cout << "   segment (" << x1 << "," << y1 << ")-(" << x2 << "," << y2 << ") / " << UNIT << endl;
+    }
+
+/** \brief random coordinate in [lo,hi], in 1/UNIT */
+int random (int lo, int hi)
+    {
+    return lo*UNIT + rand()%((hi-lo)*UNIT + 1);
+    }
+}
+
+/*******************************************************************************
+    Exported (extern) Functions
+*******************************************************************************/
+int main ()
+    {
+    SceneDescription scene={{{(float)ORIGIN_X,(float)ORIGIN_Y},
+	{(float)(ORIGIN_X + COLUMNS*CELL),(float)(ORIGIN_Y + ROWS*CELL)}},0,1,CELL};
+    DiscSet discs;
+    UniformGrid grid;
+    grid.build(scene,discs);
+    CHECK(grid.columns() == COLUMNS && grid.rows() == ROWS);
+    const int x0=ORIGIN_X, y0=ORIGIN_Y, x1=ORIGIN_X + COLUMNS*CELL, y1=ORIGIN_Y + ROWS*CELL;
+    srand(7);
+
+	// random segments within the grid
+    for (int i=0;i<3000;i++)
+	check(grid,random(x0,x1),random(y0,y1),random(x0,x1),random(y0,y1));
+
+	// axis-aligned segments, half of them along grid lines, both ways
+    for (int i=0;i<2000;i++)
+	{
+	const bool onLine=i%2 == 0;
+	if (i%4 < 2)
+	    {
+	    const int x= onLine ? (x0 + CELL*(rand()%(COLUMNS+1)))*UNIT : random(x0,x1);
+	    check(grid,x,random(y0,y1),x,random(y0,y1));
+	    }
+	else
+	    {
+	    const int y= onLine ? (y0 + CELL*(rand()%(ROWS+1)))*UNIT : random(y0,y1);
+	    check(grid,random(x0,x1),y,random(x0,x1),y);
+	    }
+	}
+
+	// segments through grid corners, in every direction and ending on corners too
+    for (int i=0;i<4000;i++)
+	{
+	const int cx=(x0 + CELL*(rand()%(COLUMNS+1)))*UNIT, cy=(y0 + CELL*(rand()%(ROWS+1)))*UNIT;
+	const int dx=rand()%9 - 4, dy=rand()%9 - 4;
+	const int before=rand()%(4*CELL), after=rand()%(4*CELL);
+	const int ax=max(x0*UNIT,min(x1*UNIT,cx - before*dx)), ay=max(y0*UNIT,min(y1*UNIT,cy - before*dy));
+	const int bx=max(x0*UNIT,min(x1*UNIT,cx + after*dx)), by=max(y0*UNIT,min(y1*UNIT,cy + after*dy));
+	/* clamping may bend the line off the corner;  only test segments still through it */
+	if ((long long)(bx-ax)*(cy-ay) == (long long)(by-ay)*(cx-ax))
+	    check(grid,ax,ay,bx,by);
+	}
+
+	// zero-length segments, inside, on the edges and outside the grid
+    for (int i=0;i<2000;i++)
+	{
+	const int x=i%2 ? random(x0-20,x1+20) : (x0 + CELL*(rand()%(COLUMNS+1)))*UNIT;
+	const int y=i%3 ? random(y0-20,y1+20) : (y0 + CELL*(rand()%(ROWS+1)))*UNIT;
+	check(grid,x,y,x,y);
+	}
+
+	// segments partly or wholly outside the grid
+    for (int i=0;i<4000;i++)
+	check(grid,random(x0-100,x1+100),random(y0-100,y1+100),random(x0-100,x1+100),random(y0-100,y1+100));
+    check(grid,(x0-10)*UNIT,y0*UNIT,(x1+10)*UNIT,y0*UNIT);
+    check(grid,(x0-10)*UNIT,y1*UNIT,(x1+10)*UNIT,y1*UNIT);
+    check(grid,x1*UNIT,(y0-10)*UNIT,x1*UNIT,(y1+10)*UNIT);
+    check(grid,(x0-10)*UNIT,(y0+10)*UNIT,(x0+10)*UNIT,(y0-10)*UNIT);
+
+    return checkResult("TraverseCellsTest");
+    }
@@ -0,0 +1,51 @@
+/**
+\file BroadPhase.h
+\brief BroadPhase.h declares the all pairs disc-disc overlap search.
+
+TO DO LIST:
+\todo
+
+BUG LIST:
+\bug
+*/
+#ifndef DISCCOLLIDE_BROAD_PHASE_H
+#define DISCCOLLIDE_BROAD_PHASE_H
+
+/*******************************************************************************
+    INCLUDES
+*******************************************************************************/
+#include <vector>
+
+#include <DiscCollide/DiscSet.h>
+#include <DiscCollide/HierarchicalGrid.h>
+#include <DiscCollide/SpatialIndex.h>
+#include <DiscCollide/ThreadPool.h>
+
+/*******************************************************************************
+    DATA TYPES
+*******************************************************************************/
+namespace ITCS4120
+{
+namespace DiscCollide
+{
+
+/** \brief DiscPair is a pair of overlapping discs, a < b */
+struct DiscPair
+    {
+    int a;
+    int b;
+    };
+
+/*
+Both searches append to 'pairs' every pair of alive discs that overlap or touch, each once.
+With a 'pool' the work is split into tasks that run in parallel; the pairs come out in the
+same order either way.
+*/
+void findAllPairs (const HierarchicalGrid& grid, const DiscSet& discs, std::vector<DiscPair>& pairs,
+	ThreadPool* pool=0);
+void findAllPairs (const SpatialIndex& index, const DiscSet& discs, std::vector<DiscPair>& pairs,
+	ThreadPool* pool=0);
+
+};
+};
+#endif
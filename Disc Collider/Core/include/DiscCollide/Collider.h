@@ -0,0 +1,163 @@
+/**
+\file Collider.h
+\brief Collider.h defines the Collider class, the headless front end of the disc collider.
+
+TO DO LIST:
+\todo
+
+BUG LIST:
+\bug
+*/
+#ifndef DISCCOLLIDE_COLLIDER_H
+#define DISCCOLLIDE_COLLIDER_H
+
+/*******************************************************************************
+    INCLUDES
+*******************************************************************************/
+#include <vector>
+
+#include <DiscCollide/BroadPhase.h>
+#include <DiscCollide/HierarchicalGrid.h>
+#include <DiscCollide/LooseQuadtree.h>
+#include <DiscCollide/Scene.h>
+#include <DiscCollide/StaticBvh.h>
+#include <DiscCollide/ThreadPool.h>
+#include <DiscCollide/UniformGrid.h>
+
+/*******************************************************************************
+    DATA TYPES
+*******************************************************************************/
+namespace ITCS4120
+{
+namespace DiscCollide
+{
+
+/**
+\brief SweptBoxResult is the result of Collider::sweptBoxQuery.
+*/
+struct SweptBoxResult
+    {
+    /** corners of the swept box in drawing order (see SweptBox::corner) */
+    float corners[4][2];
+    /** cells of the finest grid level overlapping the swept box, each once; empty unless
+	the backend is SPATIAL_GRID */
+    std::vector<int> cells;
+    /** ids of the discs the spatial index returns as candidates for the box, each once */
+    std::vector<int> candidates;
+    /** ids of the candidates that intersect the swept box, each once */
+    std::vector<int> hits;
+
+    void clear ();
+    };
+
+/**
+\brief BatchQuery is one query of a Collider::batchQuery: the segment (x1,y1)-(x2,y2) or, if
+halfWidth is positive, the box of that half width swept along it (see SweptBox).
+*/
+struct BatchQuery
+    {
+    float x1, y1, x2, y2;
+    float halfWidth;
+    };
+
+/** \brief QueryHit records that query 'query' (an index into the batch) hits disc 'disc' */
+struct QueryHit
+    {
+    int query;
+    int disc;
+    };
+
+/**
+\brief Collider owns the discs of a scene and the spatial index built over them and answers
+collision queries against them.  The index is a HierarchicalGrid, a LooseQuadtree for
+clustered discs or a StaticBvh for discs that rarely change (see SpatialBackend).  It has no OpenGL or GLUT dependency.
+
+\section Collider_USAGE Usage
+
+    Collider collider(scene);         // or collider(scene,SPATIAL_QUADTREE);
+    collider.generate(seed);          // or collider.setDiscs(myDiscs);
+    collider.sweptBoxQuery(x1,y1,x2,y2,halfWidth,result);
+    collider.batchQuery(queries,hits);  // many segments or swept boxes at once
+    collider.findAllPairs(pairs);     // every pair of overlapping discs
+    collider.removeHits(result);      // ids stay valid: removed discs become tombstones
+    collider.compactIfSparse(newId);  // between operations: drop them, newId maps the ids
+*/
+class Collider
+    {
+    public:
+    Collider (const SceneDescription& scene, SpatialBackend backend=SPATIAL_GRID, ThreadPool& pool=ThreadPool::shared());
+
+    void generate (unsigned seed);
+    void setDiscs (const DiscSet& discs);
+    void build ();
+
+    /** \brief Read accessor for 'scene_' */
+    const SceneDescription& scene () const {return scene_;}
+    /** \brief Read accessor for 'discs_' */
+    const DiscSet& discs () const {return discs_;}
+    /** \brief Write accessor for the disc colours, which the collider itself never reads */
+    unsigned* colour () {return discs_.colour();}
+    /** \brief Read accessor for 'epoch_' */
+    unsigned long long epoch () const {return epoch_;}
+    /** \brief Read accessor for 'backend_' */
+    SpatialBackend backend () const {return backend_;}
+    const SpatialIndex& index () const;
+    /** \brief Read accessor for 'grid_', empty unless backend() is SPATIAL_GRID */
+    const HierarchicalGrid& hierarchy () const {return grid_;}
+    /** \brief Read accessor for 'tree_', empty unless backend() is SPATIAL_QUADTREE */
+    const LooseQuadtree& quadtree () const {return tree_;}
+    /** \brief Read accessor for 'bvh_', empty unless backend() is SPATIAL_BVH */
+    const StaticBvh& bvh () const {return bvh_;}
+    /** \brief Read accessor for level 0 of 'grid_', the grid with the smallest cells */
+    const UniformGrid& grid () const {return grid_.level(0);}
+
+    /** \brief Read accessor for 'traversal_' */
+    UniformGrid::Traversal traversal () const {return traversal_;}
+    /** \brief Write accessor for 'traversal_' */
+    void setTraversal (UniformGrid::Traversal traversal) {traversal_=traversal;}
+
+    void segmentQuery (float x1, float y1, float x2, float y2, std::vector<int>& hits) const;
+    void sweptBoxQuery (float x1, float y1, float x2, float y2, float halfWidth, SweptBoxResult& result) const;
+    void batchQuery (const std::vector<BatchQuery>& queries, std::vector<QueryHit>& hits) const;
+    int findAllPairs (std::vector<DiscPair>& pairs, bool parallel=false) const;
+    int addDisc (float x, float y, float radius, unsigned colour);
+    void updateDisc (int id, float x, float y);
+    void updateDiscs (const std::vector<int>& ids, const std::vector<float>& x, const std::vector<float>& y);
+    void removeDisc (int id);
+    void removeDiscs (const std::vector<int>& ids);
+    /** \brief remove the discs hit by a sweptBoxQuery (see removeDiscs) */
+    void removeHits (const SweptBoxResult& result) {removeDiscs(result.hits);}
+    bool compactIfSparse (std::vector<int>& newId);
+    void compact (std::vector<int>& newId);
+    void sortDiscs ();
+
+    private:
+    enum {
+	/** minimum length, in grid cells, of each piece of a query split by splitQuery */
+	PIECE_CELLS=256
+	};
+
+    SpatialIndex& spatialIndex ();
+    void runQuery (const BatchQuery& query, std::vector<int>& cells, std::vector<int>& candidates,
+	std::vector<unsigned>& mask, std::vector<int>& hits) const;
+    void splitQuery (const BatchQuery& query, std::vector<int>& cells, std::vector<int>& candidates,
+	std::vector<int>& hits) const;
+
+    SceneDescription scene_;
+    /** threads used to build the grid and to run batch and long queries */
+    ThreadPool* pool_;
+    DiscSet discs_;
+    SpatialBackend backend_;
+    HierarchicalGrid grid_;
+    LooseQuadtree tree_;
+    StaticBvh bvh_;
+    /** walker used by segmentQuery, UniformGrid::TRAVERSAL_DDA by default */
+    UniformGrid::Traversal traversal_;
+    /** changes whenever a disc is added, moved or removed or the index is rebuilt, so a
+	query result cached along with it is current while epoch() returns the same value */
+    unsigned long long epoch_;
+    };
+
+};
+};
+#endif
@@ -0,0 +1,123 @@
+/**
+\file DiscSet.h
+\brief DiscSet.h defines the DiscSet class, the structure-of-arrays disc storage of the
+disc collider.
+
+TO DO LIST:
+\todo
+
+BUG LIST:
+\bug
+*/
+#ifndef DISCCOLLIDE_DISC_SET_H
+#define DISCCOLLIDE_DISC_SET_H
+
+/*******************************************************************************
+    INCLUDES
+*******************************************************************************/
+#include <stddef.h>
+#include <stdlib.h>
+#include <new>
+#include <vector>
+
+/*******************************************************************************
+    DATA TYPES
+*******************************************************************************/
+namespace ITCS4120
+{
+namespace DiscCollide
+{
+
+/**
+\brief AlignedAllocator is a std::vector allocator whose blocks start on an ALIGNMENT byte
+boundary, so that the arrays can be read with aligned SIMD loads.
+*/
+template <class T>
+struct AlignedAllocator
+    {
+    typedef T value_type;
+    enum {
+	/* byte alignment of every block (one AVX register) */
+	ALIGNMENT=32};
+
+    AlignedAllocator () {}
+    template <class U> AlignedAllocator (const AlignedAllocator<U>&) {}
+    template <class U> struct rebind {typedef AlignedAllocator<U> other;};
+
+    /** \brief allocate 'n' T's; the address malloc returned is stashed just below the block */
+    T* allocate (size_t n)
+	{
+	char* raw=(char*)malloc(n*sizeof(T) + ALIGNMENT + sizeof(void*));
+	if (!raw)
+	    throw std::bad_alloc();
+	char* block=raw + sizeof(void*);
+	block+=(ALIGNMENT - (size_t)block % ALIGNMENT) % ALIGNMENT;
+	((void**)block)[-1]=raw;
+	return (T*)block;
+	}
+    void deallocate (T* p, size_t)
+	{
+	if (p)
+	    free(((void**)p)[-1]);
+	}
+    };
+template <class T, class U>
+bool operator== (const AlignedAllocator<T>&, const AlignedAllocator<U>&) {return true;}
+template <class T, class U>
+bool operator!= (const AlignedAllocator<T>&, const AlignedAllocator<U>&) {return false;}
+
+/**
+\brief DiscSet stores discs as a structure of arrays:  separate, ALIGNMENT aligned x, y,
+radius, colour and alive arrays indexed by disc id.
+
+Queries only stream the x, y and radius arrays.  The colour array is payload for clients
+(packed 0xAABBGGRR, i.e. bytes R,G,B,A in memory) and is never read by the collision core.
+*/
+class DiscSet
+    {
+    public:
+    typedef std::vector<float, AlignedAllocator<float> > FloatArray;
+    typedef std::vector<unsigned, AlignedAllocator<unsigned> > ColourArray;
+    typedef std::vector<unsigned char, AlignedAllocator<unsigned char> > FlagArray;
+
+    /** \brief number of discs (alive or not) */
+    int size () const {return (int)x_.size();}
+    /** \brief number of removed discs, whose ids add reuses */
+    int removedCount () const {return (int)free_.size();}
+    /** \brief number of alive discs */
+    int aliveCount () const {return size() - removedCount();}
+    void resize (int n);
+    void clear ();
+    int add (float x, float y, float radius, unsigned colour);
+    void remove (int id);
+    void compact (std::vector<int>& newId);
+    void permute (const std::vector<int>& order, std::vector<int>& newId);
+
+    /** \brief x coordinates of the disc centres */
+    const float* x () const {return x_.data();}
+    float* x () {return x_.data();}
+    /** \brief y coordinates of the disc centres */
+    const float* y () const {return y_.data();}
+    float* y () {return y_.data();}
+    /** \brief disc radii */
+    const float* radius () const {return radius_.data();}
+    float* radius () {return radius_.data();}
+    /** \brief disc colours */
+    const unsigned* colour () const {return colour_.data();}
+    unsigned* colour () {return colour_.data();}
+    /** \brief non-zero for discs that have not been removed */
+    const unsigned char* alive () const {return alive_.data();}
+
+    private:
+    FloatArray x_;
+    FloatArray y_;
+    FloatArray radius_;
+    ColourArray colour_;
+    FlagArray alive_;
+    /** ids of the removed discs, last removed last */
+    std::vector<int> free_;
+    };
+
+};
+};
+#endif
@@ -0,0 +1,79 @@
+/**
+\file HierarchicalGrid.h
+\brief HierarchicalGrid.h defines the HierarchicalGrid class.
+
+TO DO LIST:
+\todo
+
+BUG LIST:
+\bug
+*/
+#ifndef DISCCOLLIDE_HIERARCHICAL_GRID_H
+#define DISCCOLLIDE_HIERARCHICAL_GRID_H
+
+/*******************************************************************************
+    INCLUDES
+*******************************************************************************/
+#include <vector>
+
+#include <DiscCollide/SpatialIndex.h>
+
+/*******************************************************************************
+    DATA TYPES
+*******************************************************************************/
+namespace ITCS4120
+{
+namespace DiscCollide
+{
+
+/**
+\brief HierarchicalGrid buckets discs of widely varying radii into a stack of UniformGrids.
+
+Level 0 has the cell size chosen for the scene (see chooseCellSize) and each further level
+doubles it.  A disc is registered only in the lowest level whose cells are at least as wide
+as the disc, so it overlaps at most four cells there; levels are added until the largest
+disc fits (or a cell covers the field).  A query walks every level that holds discs and
+tests each disc it finds once.  When all discs fit level 0 there is just that one level and
+the hierarchy behaves exactly like a single UniformGrid.
+*/
+class HierarchicalGrid : public SpatialIndex
+    {
+    public:
+    HierarchicalGrid ();
+
+    virtual const char* name () const {return "grid";}
+    virtual void build (const SceneDescription& scene, const DiscSet& discs, ThreadPool& pool=ThreadPool::shared());
+
+    /** \brief number of levels */
+    int levels () const {return (int)levels_.size();}
+    /** \brief the grid of level 'k'; level 0 has the smallest cells */
+    const UniformGrid& level (int k) const {return levels_[k];}
+    /** \brief number of discs registered in level 'k' */
+    int levelNoDiscs (int k) const {return levelNoDiscs_[k];}
+
+    virtual void insert (int id, float x, float y, float radius);
+    virtual void remove (int id, float x, float y, float radius);
+    virtual void move (int id, float oldX, float oldY, float x, float y, float radius);
+
+    virtual void segmentCandidates (float x1, float y1, float x2, float y2, UniformGrid::Traversal traversal,
+	std::vector<int>& cells, std::vector<int>& discs) const;
+    virtual void boxCandidates (const SweptBox& box, std::vector<int>& cells, std::vector<int>& discs) const;
+
+    private:
+    enum {MAX_LEVELS=16};
+
+    int levelFor (float radius) const;
+    template <class SelectCells> void gather (SelectCells select, std::vector<int>& cells,
+	std::vector<int>& discs) const;
+
+    /** cell size of level 0 */
+    int baseCellSize_;
+    std::vector<UniformGrid> levels_;
+    /** level each disc is registered in */
+    std::vector<unsigned char> discLevel_;
+    std::vector<int> levelNoDiscs_;
+    };
+
+};
+};
+#endif
@@ -0,0 +1,120 @@
+/**
+\file LooseQuadtree.h
+\brief LooseQuadtree.h defines the LooseQuadtree class.
+
+TO DO LIST:
+\todo
+
+BUG LIST:
+\bug
+*/
+#ifndef DISCCOLLIDE_LOOSE_QUADTREE_H
+#define DISCCOLLIDE_LOOSE_QUADTREE_H
+
+/*******************************************************************************
+    INCLUDES
+*******************************************************************************/
+#include <vector>
+
+#include <DiscCollide/SpatialIndex.h>
+
+/*******************************************************************************
+    DATA TYPES
+*******************************************************************************/
+namespace ITCS4120
+{
+namespace DiscCollide
+{
+
+/**
+\brief LooseQuadtree is a SpatialIndex that subdivides the play field only where discs
+crowd, so clustered discs cost neither the empty cells nor the overfull cells of a grid.
+
+A node is a square; its loose bounds are the square grown by half its size on every side.
+A disc is kept in the deepest node that contains its centre and whose half size is at least
+its radius, so the disc lies inside the node's loose bounds and every disc is stored exactly
+once.  A leaf splits into four children when it holds more than LEAF_CAPACITY discs, and
+children whose parent falls back to LEAF_CAPACITY/2 discs are merged into it again.
+
+The nodes are allocated from an arena in blocks of four siblings; freed blocks are reused
+before the arena grows.  The discs of a node are a contiguous run of a second arena shared by
+all nodes, so queries read ids sequentially, and every disc remembers its slot in that run,
+so insert, remove and move cost O(depth).  Runs hold a power of two of slots; a node that
+fills its run moves to one twice the size and leaves the old run on a free list of its size
+for the next node that grows to it.  A freed block keeps the runs of its nodes.
+*/
+class LooseQuadtree : public SpatialIndex
+    {
+    public:
+    LooseQuadtree ();
+
+    virtual const char* name () const {return "quadtree";}
+    virtual void build (const SceneDescription& scene, const DiscSet& discs, ThreadPool& pool=ThreadPool::shared());
+
+    /** \brief number of nodes in use */
+    int nodeCount () const {return (int)nodes_.size() - 4*(int)freeBlocks_.size();}
+    /** \brief depth of the deepest node */
+    int depth () const;
+
+    virtual void insert (int id, float x, float y, float radius);
+    virtual void remove (int id, float x, float y, float radius);
+    virtual void move (int id, float oldX, float oldY, float x, float y, float radius);
+
+    virtual void segmentCandidates (float x1, float y1, float x2, float y2, UniformGrid::Traversal traversal,
+	std::vector<int>& cells, std::vector<int>& discs) const;
+    virtual void boxCandidates (const SweptBox& box, std::vector<int>& cells, std::vector<int>& discs) const;
+
+    private:
+    enum {
+	LEAF_CAPACITY=16,
+	MAX_DEPTH=24,
+	/* slots of the smallest run of nodeDiscs_ */
+	MIN_RUN=4
+	};
+
+    struct Node
+	{
+	/** centre of the square */
+	float x, y;
+	/** half its side; the loose bounds reach 2*half from the centre */
+	float half;
+	int depth;
+	int parent;
+	/** first of the four children, or -1 for a leaf */
+	int children;
+	/** discs in the node's subtree */
+	int total;
+	/** discs held by the node itself: 'count' ids from nodeDiscs_[first] on, in a run of
+	    'capacity' slots (none while 'capacity' is 0) */
+	int first, count, capacity;
+	};
+
+    int allocateBlock ();
+    int allocateRun (int capacity);
+    void freeRun (int first, int capacity);
+    void grow (int node);
+    int childFor (int node, float x, float y, float radius) const;
+    void link (int node, int id);
+    void unlink (int id);
+    void place (int id, float x, float y, float radius);
+    void split (int node);
+    void mergeUp (int node);
+
+    std::vector<Node> nodes_;
+    /** first node of each free block of four */
+    std::vector<int> freeBlocks_;
+    /** arena of the runs of disc ids of all nodes */
+    std::vector<int> nodeDiscs_;
+    /** first slot of each free run of nodeDiscs_, by size: MIN_RUN << k slots in freeRuns_[k] */
+    std::vector<std::vector<int> > freeRuns_;
+    /** node holding each disc, or -1 */
+    std::vector<int> discNode_;
+    /** index of each disc in the discs of its node */
+    std::vector<int> discSlot_;
+    /** centres and radii of the registered discs, used when nodes split */
+    std::vector<float> discX_, discY_, discRadius_;
+    };
+
+};
+};
+#endif
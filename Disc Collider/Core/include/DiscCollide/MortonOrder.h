@@ -0,0 +1,57 @@
+/**
+\file MortonOrder.h
+\brief MortonOrder.h declares the Z-order (Morton) sort that renumbers discs so that discs
+close in the field are close in the DiscSet.
+
+TO DO LIST:
+\todo
+
+BUG LIST:
+\bug
+*/
+#ifndef DISCCOLLIDE_MORTON_ORDER_H
+#define DISCCOLLIDE_MORTON_ORDER_H
+
+/*******************************************************************************
+    INCLUDES
+*******************************************************************************/
+#include <vector>
+
+#include <DiscCollide/DiscSet.h>
+#include <DiscCollide/UniformGrid.h>
+
+/*******************************************************************************
+    DATA TYPES
+*******************************************************************************/
+namespace ITCS4120
+{
+namespace DiscCollide
+{
+
+/**
+\brief 'mortonCode' interleaves the bits of column 'gx' (even bits) and row 'gy' (odd bits).
+Sorting cells by it walks the grid along a Z-order curve, which keeps neighbouring cells
+mostly close in the order.
+*/
+inline unsigned long long mortonCode (unsigned gx, unsigned gy)
+    {
+    unsigned long long x=gx, y=gy;
+    x=(x | x << 16) & 0x0000FFFF0000FFFFull;
+    x=(x | x << 8) & 0x00FF00FF00FF00FFull;
+    x=(x | x << 4) & 0x0F0F0F0F0F0F0F0Full;
+    x=(x | x << 2) & 0x3333333333333333ull;
+    x=(x | x << 1) & 0x5555555555555555ull;
+    y=(y | y << 16) & 0x0000FFFF0000FFFFull;
+    y=(y | y << 8) & 0x00FF00FF00FF00FFull;
+    y=(y | y << 4) & 0x0F0F0F0F0F0F0F0Full;
+    y=(y | y << 2) & 0x3333333333333333ull;
+    y=(y | y << 1) & 0x5555555555555555ull;
+    return x | y << 1;
+    }
+
+void radixSort (std::vector<unsigned long long>& keys, std::vector<int>& values);
+void mortonOrder (const UniformGrid& grid, const DiscSet& discs, std::vector<int>& order);
+
+};
+};
+#endif
@@ -0,0 +1,79 @@
+/**
+\file QueryContext.h
+\brief QueryContext.h defines the QueryContext class, the per thread scratch state of a query.
+
+TO DO LIST:
+\todo
+
+BUG LIST:
+\bug
+*/
+#ifndef DISCCOLLIDE_QUERY_CONTEXT_H
+#define DISCCOLLIDE_QUERY_CONTEXT_H
+
+/*******************************************************************************
+    INCLUDES
+*******************************************************************************/
+#include <vector>
+
+/*******************************************************************************
+    DATA TYPES
+*******************************************************************************/
+namespace ITCS4120
+{
+namespace DiscCollide
+{
+
+/**
+\brief QueryContext lets a query process each grid cell and each disc at most once.
+
+Every cell and every disc carries a stamp.  begin starts a query by advancing the epoch, so
+all stamps become stale at once and nothing has to be cleared between queries; a visit
+stamps the cell or disc with the current epoch.  The stamps are cleared only when the 32 bit
+epoch wraps around.
+
+A QueryContext must not be shared by queries running at the same time; forThread gives each
+thread its own.
+
+\section QueryContext_USAGE Usage
+
+    QueryContext& context=QueryContext::forThread();
+    context.begin(grid.cellCount(),discs.size());
+    if (context.firstCellVisit(c)) ...
+*/
+class QueryContext
+    {
+    public:
+    QueryContext ();
+
+    void begin (int cells, int discs);
+
+    /** \brief true if cell 'c' has not yet been visited by the current query, and mark it visited */
+    bool firstCellVisit (int c)
+	{
+	if (cellStamp_[c] == epoch_)
+	    return false;
+	cellStamp_[c] = epoch_;
+	return true;
+	}
+    /** \brief true if disc 'id' has not yet been visited by the current query, and mark it visited */
+    bool firstDiscVisit (int id)
+	{
+	if (discStamp_[id] == epoch_)
+	    return false;
+	discStamp_[id] = epoch_;
+	return true;
+	}
+
+    static QueryContext& forThread ();
+
+    private:
+    std::vector<unsigned> cellStamp_;
+    std::vector<unsigned> discStamp_;
+    /** stamp of the current query; 0 is never used so fresh stamps are stale */
+    unsigned epoch_;
+    };
+
+};
+};
+#endif
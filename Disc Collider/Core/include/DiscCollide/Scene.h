@@ -0,0 +1,55 @@
+/**
+\file Scene.h
+\brief Scene.h defines the SceneDescription used to set up a disc collider.
+
+TO DO LIST:
+\todo
+
+BUG LIST:
+\bug
+*/
+#ifndef DISCCOLLIDE_SCENE_H
+#define DISCCOLLIDE_SCENE_H
+
+/*******************************************************************************
+    INCLUDES
+*******************************************************************************/
+#include <DiscCollide/DiscSet.h>
+
+/*******************************************************************************
+    DATA TYPES
+*******************************************************************************/
+namespace ITCS4120
+{
+/**
+\brief DiscCollide is the headless (no OpenGL/GLUT) collision core of the Disc Collider.
+*/
+namespace DiscCollide
+{
+
+/**
+\brief SceneDescription holds the startup parameters of a disc collider.  All grid
+dimensions and cell arithmetic are derived from it.
+*/
+struct SceneDescription
+    {
+    /** lowerLeft and upperRight corner of the axis aligned play field in world coordinates */
+    float field[2][2];
+    /** number of discs scattered over the field */
+    int discCount;
+    /** radius of every generated disc, or the smallest one (see maxDiscRadius) */
+    int discRadius;
+    /** width and height of a grid cell, or 0 to choose one from discRadius and the disc density
+	(see chooseCellSize) */
+    int cellSize;
+    /** if greater than discRadius, generated radii are spread log-uniformly from discRadius
+	to maxDiscRadius */
+    int maxDiscRadius;
+    };
+
+int  chooseCellSize (const SceneDescription& scene);
+void generateDiscs (const SceneDescription& scene, unsigned seed, DiscSet& discs);
+
+};
+};
+#endif
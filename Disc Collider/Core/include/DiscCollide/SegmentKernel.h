@@ -0,0 +1,86 @@
+/**
+\file SegmentKernel.h
+\brief SegmentKernel.h defines the batch segment-versus-disc and box-versus-disc tests used
+by the Collider.
+
+TO DO LIST:
+\todo
+
+BUG LIST:
+\bug
+*/
+#ifndef DISCCOLLIDE_SEGMENT_KERNEL_H
+#define DISCCOLLIDE_SEGMENT_KERNEL_H
+
+/*******************************************************************************
+    DATA TYPES
+*******************************************************************************/
+namespace ITCS4120
+{
+namespace DiscCollide
+{
+
+/**
+\brief Segment is the segment (x1,y1)-(x2,y2) prepared for the batch disc tests.  The
+reciprocal of its squared length is computed once, so the tests compare squared distances
+with no division or square root per disc.
+*/
+struct Segment
+    {
+    Segment (float x1, float y1, float x2, float y2);
+
+    float x1, y1;
+    /** x2-x1 and y2-y1 */
+    float dx, dy;
+    /** 1/(dx*dx + dy*dy), or 0 for a degenerate segment */
+    float invLen2;
+    };
+
+/**
+\brief SweptBox is the oriented rectangle swept by a segment of length 2*halfWidth that
+moves perpendicular to itself from (x1,y1) to (x2,y2), its centre tracing the box axis.
+*/
+struct SweptBox
+    {
+    SweptBox (float x1, float y1, float x2, float y2, float halfWidth);
+
+    void corner (int i, float p[2]) const;
+
+    float x1, y1;
+    /** unit direction of the axis */
+    float ux, uy;
+    float length;
+    float halfWidth;
+    };
+
+/** \brief SegmentKernel names an implementation of the batch tests */
+enum SegmentKernel
+    {
+    SEGMENT_KERNEL_SCALAR,
+    SEGMENT_KERNEL_SSE2,	    ///< 4 discs per instruction
+    SEGMENT_KERNEL_AVX2	    ///< 8 discs per instruction
+    };
+
+/** \brief number of 32 bit words in the hit mask of a batch of 'n' discs */
+inline int hitMaskWords (int n) {return (n + 31)/32;}
+
+/*
+The batch tests read the discs ids[0] ... ids[n-1] from the structure of arrays 'x', 'y',
+'radius'; when 'ids' is 0 they read the contiguous discs 0 ... n-1 instead.  Bit i%32 of
+mask[i/32] is set when the i-th disc of the batch is hit.  'mask' must hold hitMaskWords(n)
+words.  Every kernel does the same single precision arithmetic, so all of them return the
+same masks.
+*/
+void segmentHits (const Segment& segment, const float* x, const float* y, const float* radius,
+	const int* ids, int n, unsigned* mask);
+void boxHits (const SweptBox& box, const float* x, const float* y, const float* radius,
+	const int* ids, int n, unsigned* mask);
+
+SegmentKernel bestSegmentKernel ();
+SegmentKernel segmentKernel ();
+SegmentKernel setSegmentKernel (SegmentKernel kernel);
+const char* segmentKernelName (SegmentKernel kernel);
+
+};
+};
+#endif
@@ -0,0 +1,74 @@
+/**
+\file SpatialIndex.h
+\brief SpatialIndex.h defines the SpatialIndex interface shared by the spatial index backends
+of the Collider.
+
+TO DO LIST:
+\todo
+
+BUG LIST:
+\bug
+*/
+#ifndef DISCCOLLIDE_SPATIAL_INDEX_H
+#define DISCCOLLIDE_SPATIAL_INDEX_H
+
+/*******************************************************************************
+    INCLUDES
+*******************************************************************************/
+#include <vector>
+
+#include <DiscCollide/Scene.h>
+#include <DiscCollide/ThreadPool.h>
+#include <DiscCollide/UniformGrid.h>
+
+/*******************************************************************************
+    DATA TYPES
+*******************************************************************************/
+namespace ITCS4120
+{
+namespace DiscCollide
+{
+
+/** \brief SpatialBackend names an implementation of SpatialIndex */
+enum SpatialBackend
+    {
+    SPATIAL_GRID,	    ///< HierarchicalGrid, best for evenly spread discs
+    SPATIAL_QUADTREE,	    ///< LooseQuadtree, best for clustered discs
+    SPATIAL_BVH		    ///< StaticBvh, best for discs that rarely change
+    };
+
+/**
+\brief SpatialIndex maps regions of the play field to the ids of the discs that may overlap
+them.  The Collider keeps its discs in one and tests the candidates it returns exactly.
+
+A query returns every disc that overlaps the region, each once, and possibly some that do
+not.  The 'cells' a query also returns are the level 0 cells of a grid index that the
+region crosses; other backends return none.
+*/
+class SpatialIndex
+    {
+    public:
+    virtual ~SpatialIndex () {}
+
+    /** \brief short name of the backend, for reports */
+    virtual const char* name () const = 0;
+
+    /** \brief rebuild the index over the alive 'discs' of 'scene' */
+    virtual void build (const SceneDescription& scene, const DiscSet& discs, ThreadPool& pool=ThreadPool::shared()) = 0;
+    /** \brief register disc 'id', of radius 'radius' centred at (x,y) */
+    virtual void insert (int id, float x, float y, float radius) = 0;
+    /** \brief unregister disc 'id', of radius 'radius' centred at (x,y) */
+    virtual void remove (int id, float x, float y, float radius) = 0;
+    /** \brief re-register disc 'id' of radius 'radius' after it moved from (oldX,oldY) to (x,y) */
+    virtual void move (int id, float oldX, float oldY, float x, float y, float radius) = 0;
+
+    /** \brief candidates for the segment (x1,y1)-(x2,y2); a grid walks it with 'traversal' */
+    virtual void segmentCandidates (float x1, float y1, float x2, float y2, UniformGrid::Traversal traversal,
+	std::vector<int>& cells, std::vector<int>& discs) const = 0;
+    /** \brief candidates for 'box' */
+    virtual void boxCandidates (const SweptBox& box, std::vector<int>& cells, std::vector<int>& discs) const = 0;
+    };
+
+};
+};
+#endif
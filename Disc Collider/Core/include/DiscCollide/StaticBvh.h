@@ -0,0 +1,112 @@
+/**
+\file StaticBvh.h
+\brief StaticBvh.h defines the StaticBvh class.
+
+TO DO LIST:
+\todo
+
+BUG LIST:
+\bug
+*/
+#ifndef DISCCOLLIDE_STATIC_BVH_H
+#define DISCCOLLIDE_STATIC_BVH_H
+
+/*******************************************************************************
+    INCLUDES
+*******************************************************************************/
+#include <vector>
+
+#include <DiscCollide/SpatialIndex.h>
+
+/*******************************************************************************
+    DATA TYPES
+*******************************************************************************/
+namespace ITCS4120
+{
+namespace DiscCollide
+{
+
+/**
+\brief StaticBvh is a SpatialIndex for discs that rarely change: a bounding volume hierarchy
+over the disc bounding boxes, bulk loaded with Sort-Tile-Recursive (STR) packing.
+
+Leaves hold up to LEAF_SIZE discs and every node has four children, whose bounding boxes it
+stores side by side so that one SSE2 test (or a scalar loop, see segmentKernel) checks all
+four against the query.  The nodes live in one array in breadth first order: the root first,
+the children of a node next to each other and each level after the one above.  The discs of
+the leaves are stored in leaf order, so a query reads them sequentially.
+
+The tree is not rebalanced on change.  A removed disc is dropped from its leaf and a moved
+disc stays in its leaf while it fits the leaf's box.  Other moved and inserted discs go to an
+overflow list that every query scans; once that list outgrows a sixteenth of the discs the
+tree is packed again.
+*/
+class StaticBvh : public SpatialIndex
+    {
+    public:
+    StaticBvh ();
+
+    virtual const char* name () const {return "bvh";}
+    virtual void build (const SceneDescription& scene, const DiscSet& discs, ThreadPool& pool=ThreadPool::shared());
+
+    /** \brief number of nodes */
+    int nodeCount () const {return (int)nodes_.size();}
+    /** \brief number of leaves */
+    int leafCount () const {return (int)leafStart_.size();}
+    /** \brief number of discs waiting in the overflow list */
+    int overflowCount () const {return (int)overflow_.size();}
+    /** \brief number of levels of inner nodes, the root's included */
+    int height () const {return height_;}
+
+    virtual void insert (int id, float x, float y, float radius);
+    virtual void remove (int id, float x, float y, float radius);
+    virtual void move (int id, float oldX, float oldY, float x, float y, float radius);
+
+    virtual void segmentCandidates (float x1, float y1, float x2, float y2, UniformGrid::Traversal traversal,
+	std::vector<int>& cells, std::vector<int>& discs) const;
+    virtual void boxCandidates (const SweptBox& box, std::vector<int>& cells, std::vector<int>& discs) const;
+
+    /**
+    \brief Node holds the bounding boxes of its four children.  child[k] is the index of an
+    inner node, or -1-l for leaf l; an unused child has an empty box.
+    */
+    struct Node
+	{
+	float minX[4], minY[4], maxX[4], maxY[4];
+	int child[4];
+	};
+
+    private:
+    enum {
+	LEAF_SIZE=8,
+	/** most levels of inner nodes:  2^31 disc ids fill fewer than 4^14 leaves */
+	MAX_HEIGHT=16,
+	/** discLeaf_ of a disc in the overflow list */
+	IN_OVERFLOW=-2
+	};
+
+    void pack ();
+    void addToOverflow (int id);
+    void dropFromLeaf (int id);
+    bool fitsLeaf (int leaf, float x, float y, float radius) const;
+
+    std::vector<Node> nodes_;
+    /** levels of inner nodes, set by pack */
+    int height_;
+    /** leaf l holds discs_[leafStart_[l]] ... discs_[leafStart_[l] + leafCount_[l] - 1] */
+    std::vector<int> discs_;
+    std::vector<int> leafStart_, leafCount_;
+    /** bounding box of each leaf as its parent stores it: min x, min y, max x, max y */
+    std::vector<float> leafBounds_;
+    std::vector<int> overflow_;
+    /** leaf of each disc, IN_OVERFLOW, or -1 if not registered */
+    std::vector<int> discLeaf_;
+    /** index of each disc in discs_ or in overflow_ */
+    std::vector<int> discSlot_;
+    /** centres and radii of the registered discs, used when the tree is packed again */
+    std::vector<float> discX_, discY_, discRadius_;
+    };
+
+};
+};
+#endif
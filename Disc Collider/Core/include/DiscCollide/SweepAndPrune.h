@@ -0,0 +1,100 @@
+/**
+\file SweepAndPrune.h
+\brief SweepAndPrune.h defines the SweepAndPrune class.
+
+TO DO LIST:
+\todo
+
+BUG LIST:
+\bug
+*/
+#ifndef DISCCOLLIDE_SWEEP_AND_PRUNE_H
+#define DISCCOLLIDE_SWEEP_AND_PRUNE_H
+
+/*******************************************************************************
+    INCLUDES
+*******************************************************************************/
+#include <unordered_set>
+#include <vector>
+
+#include <DiscCollide/BroadPhase.h>
+#include <DiscCollide/DiscSet.h>
+
+/*******************************************************************************
+    DATA TYPES
+*******************************************************************************/
+namespace ITCS4120
+{
+namespace DiscCollide
+{
+
+/**
+\brief SweepAndPrune finds the overlapping pairs of a DiscSet by keeping the ends of the disc
+bounding boxes sorted along x and along y.
+
+Each update refreshes the ends from the discs and restores the order by insertion sort, which
+costs little when the discs moved a little since the last update.  Two boxes start or stop
+overlapping only when an end of one passes an end of the other, so the set of overlapping
+boxes is kept up to date from those swaps alone, and is touched only by the pairs whose
+state really changed since the last update.  It reads the same DiscSet as the Collider,
+so the two broad phases can be compared on the same discs.
+
+\section SweepAndPrune_USAGE Usage
+
+    SweepAndPrune sap;
+    sap.build(collider.discs());
+    ...                               // move discs with collider.updateDiscs
+    sap.update(collider.discs());
+    sap.findPairs(collider.discs(),pairs);
+*/
+class SweepAndPrune
+    {
+    public:
+    SweepAndPrune ();
+
+    void build (const DiscSet& discs);
+    void update (const DiscSet& discs);
+    void findPairs (const DiscSet& discs, std::vector<DiscPair>& pairs) const;
+
+    /** \brief number of pairs of alive discs whose bounding boxes overlap */
+    int boxPairs () const {return (int)boxPairs_.size();}
+    /** \brief number of end swaps made by the last update */
+    long long swaps () const {return swaps_;}
+
+    private:
+    /** \brief Endpoint is one end of a disc bounding box along one axis */
+    struct Endpoint
+	{
+	float value;
+	/** disc id << 1, plus 1 for the upper end */
+	unsigned end;
+	};
+
+    /** \brief Box is the bounding box of a disc, empty (lo > hi) for a dead disc */
+    struct Box
+	{
+	float lo[2];
+	float hi[2];
+	};
+    /** \brief DiscBoxes holds the box of a disc at this update and at the one before */
+    struct DiscBoxes
+	{
+	Box box;
+	Box oldBox;
+	};
+
+    void readBoxes (const DiscSet& discs);
+    void sortAxis (int axis);
+
+    int count_;
+    long long swaps_;
+    /** the ends along x and along y, sorted */
+    std::vector<Endpoint> ends_[2];
+    std::vector<DiscBoxes> boxes_;
+    /** the pairs of discs whose boxes overlap, as a << 32 | b with a < b */
+    std::unordered_set<unsigned long long> boxPairs_;
+    };
+
+};
+};
+#endif
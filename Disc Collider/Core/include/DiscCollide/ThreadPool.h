@@ -0,0 +1,102 @@
+/**
+\file ThreadPool.h
+\brief ThreadPool.h defines the ThreadPool class.
+
+TO DO LIST:
+\todo
+
+BUG LIST:
+\bug
+*/
+#ifndef DISCCOLLIDE_THREAD_POOL_H
+#define DISCCOLLIDE_THREAD_POOL_H
+
+/*******************************************************************************
+    INCLUDES
+*******************************************************************************/
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*******************************************************************************
+    DATA TYPES
+*******************************************************************************/
+namespace ITCS4120
+{
+namespace DiscCollide
+{
+
+/**
+\brief ThreadPool runs a set of numbered tasks on a fixed group of worker threads.
+
+The thread calling run takes part in the work, so a ThreadPool of size() 1 has no
+workers and runs everything on the caller.  Calls to run from inside a running task
+execute serially on the calling thread.
+
+Tasks are scheduled by work stealing: every thread starts on its own contiguous share of
+the task numbers, so neighbouring tasks (say, neighbouring cell ranges) tend to run on the
+same thread, and a thread that runs out steals the back half of the largest share left.
+
+\section ThreadPool_USAGE Usage
+
+    ThreadPool pool(8);
+    pool.run(blocks, [&](int block, int thread) { ... });
+*/
+class ThreadPool
+    {
+    public:
+    /** Task is called with the task number and the index (0 ... size()-1) of the running thread */
+    typedef std::function<void (int task, int thread)> Task;
+
+    explicit ThreadPool (int threads=0);
+    ~ThreadPool ();
+
+    /** \brief number of threads that run tasks, including the caller of run */
+    int size () const {return (int)workers_.size()+1;}
+
+    void run (int tasks, const Task& task);
+
+    static ThreadPool& shared ();
+
+    private:
+    ThreadPool (const ThreadPool&);
+    ThreadPool& operator= (const ThreadPool&);
+
+    /** \brief TaskRange is the share [begin,end) of a thread, packed as end<<32 | begin */
+    struct TaskRange
+	{
+	std::atomic<unsigned long long> range;
+	/* keep the shares of different threads on different cache lines */
+	char padding[64 - sizeof(std::atomic<unsigned long long>)];
+	};
+
+    void workerLoop (int thread);
+    void drain (int thread);
+    int take (int thread);
+    bool steal (int thread);
+
+    std::vector<std::thread> workers_;
+    /** serializes concurrent calls to run */
+    std::mutex runMutex_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    /** current job; valid while busy_ > 0 */
+    const Task* task_;
+    int tasks_;
+    /** share of the current job left to each thread */
+    std::unique_ptr<TaskRange[]> ranges_;
+    /** workers that have not yet finished the current job */
+    int busy_;
+    /** incremented for every job so workers can tell a new job from a spurious wake up */
+    unsigned generation_;
+    bool stop_;
+    };
+
+};
+};
+#endif
@@ -32,10 +32,14 @@ REFERENCES:
 #include <windows.h>
 #endif
 
+#include <algorithm>
 #include <assert.h>
 #include <iostream>
 #include <math.h>
+#include <stdlib.h>
+#include <string.h>
 #include <time.h>
+#include <vector>
 
 #if 0
 #include <GL/gl.h>
@@ -50,14 +54,124 @@ REFERENCES:
 #include <OpenGLTrainer/PanZoomWindow.h>
 #include <OpenGLTrainer/Framebuffer.h>
 
+#include <DiscCollide/Collider.h>
+#include <DiscCollide/SegmentKernel.h>
+
 using namespace std;
+using namespace ITCS4120::DiscCollide;
+
+/*******************************************************************************
+    File Scope Data Types
+*******************************************************************************/
+/**
+\brief DemoOptions holds the command line options that configure the collider rather than
+the scene.
+*/
+struct DemoOptions
+    {
+    /** spatial index the collider keeps its discs in */
+    SpatialBackend backend;
+    /** renumber the discs in Z-order once they are generated (see Collider::sortDiscs) */
+    bool sortDiscs;
+    };
+
+/**
+\brief DiscLod is a level of detail of the disc drawing: a fan of 'segments' rim segments, or
+a point when 'segments' is 0, used while the largest disc is at least 'minPixels' in radius
+on screen.
+*/
+struct DiscLod
+    {
+    int segments;
+    float minPixels;
+    };
+
+/**
+\brief DiscInstance is the per disc data of the instanced disc draw: centre, radius (0 for a
+dead disc) and colour packed as 0xAABBGGRR, so its bytes are in RGBA order.
+*/
+struct DiscInstance
+    {
+    float x;
+    float y;
+    float radius;
+    unsigned colour;
+    };
 
 /*******************************************************************************
     File Scope (static) Globals
 *******************************************************************************/
-/** lowerLeft and upperRight corner of axis aligned rectangle in world coordinates
-    where we will draw all our stuff */
-static const float PLAY_FIELD[2][2] = {{0,0},{1e6,1e6}};
+/** scene used unless overridden on the command line */
+static const SceneDescription DEFAULT_SCENE = {{{0,0},{1e6,1e6}}, 100000, 250, 0, 0};
+/** options used unless overridden on the command line */
+static const DemoOptions DEFAULT_OPTIONS = {SPATIAL_GRID, false};
+/** levels of detail of the discs, from the finest; the circle buffer holds their fans in
+    this order, each as the centre and segments+1 rim points, the first and last coinciding */
+static const DiscLod DISC_LODS[] = {{36, 32}, {12, 8}, {6, 2}, {0, 0}};
+static const int DISC_LOD_COUNT = sizeof(DISC_LODS)/sizeof(DISC_LODS[0]);
+
+static constexpr double PI = 3.14159265358979323846;
+
+/**
+\brief 'TaylorSine' sums the Taylor series of sin(x) from its n-th term 'term' on.
+*/
+static constexpr double TaylorSine (double x, double term, int n)
+    {
+    return n > 14 ? 0 : term + TaylorSine(x,-term*x*x/((2*n)*(2*n + 1)),n + 1);
+    }
+
+/**
+\brief 'ConstSine' is sin(x) for x in [-PI,3*PI], evaluated at compile time.
+*/
+static constexpr double ConstSine (double x)
+    {
+    return x > PI ? -TaylorSine(x - PI,x - PI,1) : TaylorSine(x,x,1);
+    }
+
+/** point 'k' of the unit circle split into 36 segments */
+#define UNIT_CIRCLE_POINT(k) {(float)ConstSine((k)*PI/18 + PI/2), (float)ConstSine((k)*PI/18)}
+/** the unit circle split into 36 segments, the first and last point coinciding; every 3rd
+    and every 6th point give the coarser fans */
+static constexpr float UNIT_CIRCLE[37][2] =
+    {
+    UNIT_CIRCLE_POINT(0),  UNIT_CIRCLE_POINT(1),  UNIT_CIRCLE_POINT(2),  UNIT_CIRCLE_POINT(3),
+    UNIT_CIRCLE_POINT(4),  UNIT_CIRCLE_POINT(5),  UNIT_CIRCLE_POINT(6),  UNIT_CIRCLE_POINT(7),
+    UNIT_CIRCLE_POINT(8),  UNIT_CIRCLE_POINT(9),  UNIT_CIRCLE_POINT(10), UNIT_CIRCLE_POINT(11),
+    UNIT_CIRCLE_POINT(12), UNIT_CIRCLE_POINT(13), UNIT_CIRCLE_POINT(14), UNIT_CIRCLE_POINT(15),
+    UNIT_CIRCLE_POINT(16), UNIT_CIRCLE_POINT(17), UNIT_CIRCLE_POINT(18), UNIT_CIRCLE_POINT(19),
+    UNIT_CIRCLE_POINT(20), UNIT_CIRCLE_POINT(21), UNIT_CIRCLE_POINT(22), UNIT_CIRCLE_POINT(23),
+    UNIT_CIRCLE_POINT(24), UNIT_CIRCLE_POINT(25), UNIT_CIRCLE_POINT(26), UNIT_CIRCLE_POINT(27),
+    UNIT_CIRCLE_POINT(28), UNIT_CIRCLE_POINT(29), UNIT_CIRCLE_POINT(30), UNIT_CIRCLE_POINT(31),
+    UNIT_CIRCLE_POINT(32), UNIT_CIRCLE_POINT(33), UNIT_CIRCLE_POINT(34), UNIT_CIRCLE_POINT(35),
+    UNIT_CIRCLE_POINT(36)
+    };
+#undef UNIT_CIRCLE_POINT
+/** dirty discs closer than this are uploaded as one range */
+static const int DIRTY_RANGE_GAP = 16;
+/** discs are culled to the view window while it covers less than this fraction of the field */
+static const float CULL_VIEW_FRACTION = 0.5f;
+
+/** places the unit circle vertex 'corner' on the disc of an instance */
+static const char* DISC_VERTEX_SHADER =
+    "#version 120\n"
+    "attribute vec2 corner;\n"
+    "attribute vec3 disc;\n"
+    "attribute vec4 colour;\n"
+    "uniform float pixelsPerUnit;\n"
+    "varying vec4 discColour;\n"
+    "void main ()\n"
+    "    {\n"
+    "    discColour = colour;\n"
+    "    gl_PointSize = max(1.0,2.0*disc.z*pixelsPerUnit);\n"
+    "    gl_Position = gl_ModelViewProjectionMatrix*vec4(disc.xy + disc.z*corner,0.0,1.0);\n"
+    "    }\n";
+static const char* DISC_FRAGMENT_SHADER =
+    "#version 120\n"
+    "varying vec4 discColour;\n"
+    "void main ()\n"
+    "    {\n"
+    "    gl_FragColor = discColour;\n"
+    "    }\n";
 
 /*******************************************************************************
     File Scope (static) Functions
@@ -67,7 +181,7 @@ using namespace ITCS4120::OpenGLTrainer;
 class MyPanZoomWindow : public PanZoomWindow
     {
     public:
-    MyPanZoomWindow (const float viewLowerLeft[2], const float viewUpperRight[2]);
+    MyPanZoomWindow (const SceneDescription& scene, const DemoOptions& options);
     
     /** Overridden callback member functions.
 
@@ -93,43 +207,51 @@ class MyPanZoomWindow : public PanZoomWindow
     functionality of PanZoomWindow.  They are provided just to illustrate proper usage of 
     a PanZoomWindow derived class.
     */
-    struct Disc
-	{
-	int x;
-	int y;
-	float rvalue;
-	float gvalue;
-	float bvalue;
-	}discs[100000];
-    struct Grid
-	{
-	int x;
-	int y;
-	int noDiscs;
-	bool selected;
-	Disc * containedDiscs[10];
-	}playGrid[1000][1000];
-
-    void InsertDiscs();
-    void DrawDiscs(float cx,float cy);
-    void GenerateDiscs();
-    void Initialize();
-    GLuint createDL();
+    /** headless collision core: discs, grid and queries */
+    Collider collider;
+    /** result of the query for the currently selected pair of cells */
+    SweptBoxResult selection;
+    /** 'selection' is the result for the cells 'selectionKey' while collider.epoch() is
+	'selectionEpoch', which is 0 before the first query */
+    unsigned long long selectionEpoch;
+    int selectionKey[4];
+    /** corners of the quads of 'selection.cells', three coordinates each */
+    std::vector<float> selectionCellVertices;
+
+    void DrawDiscs();
+    void SelectCells(int cell1x, int cell1y, int cell2x, int cell2y);
+    void DrawSelectedCells();
+    void ColourDiscs(const std::vector<int>& ids, float r, float g, float b);
+    void createDiscBuffers();
+    void uploadDiscs();
+    int CullDiscs();
     //void changeSize(int w, int h) ;
     inline void ZJW_mouse (int button, int state, int x, int y);
     inline void ZJW_passiveMotion (int x, int y);    
     inline void ZJW_motion(int gx, int gy);
     void ZJW_draw_frame();
-    void SelectIntersectedCells(int x1,int y1,int x2,int y2, bool bline);
-    void setPixel(int px, int py, int x1, int y1, int x2, int y2, bool bline);
-    void highlightDiscsFunc();
-    void DeleteIntersectedDiscs(int x1,int y1,int x2,int y2,Disc * containedDiscs, bool bline);
 
     bool ZJW_drag;
-    int cell_width;
-    int cell_height;
-    int disc_radius;
-    GLuint discID;
+    /** unit circle fan, drawn once per disc with the instance data in 'discBuffer' */
+    GLuint circleBuffer;
+    /** one DiscInstance per disc of the collider */
+    GLuint discBuffer;
+    GLuint discProgram;
+    GLint cornerAttribute, discAttribute, colourAttribute, pixelsPerUnitUniform;
+    /** number of discs in 'discBuffer' */
+    int discBufferSize;
+    /** discs whose DiscInstance changed since the last upload */
+    std::vector<int> dirtyDiscs;
+    /** reupload every disc, after the discs were renumbered */
+    bool allDiscsDirty;
+    /** new id of every old id after the collider last compacted its discs */
+    std::vector<int> renumbered;
+    /** the DiscInstances of the discs in view, refilled every frame while culling */
+    GLuint visibleBuffer;
+    /** staging area of uploadDiscs and DrawDiscs */
+    std::vector<DiscInstance> discInstances;
+    /** cells and discs in view, from the spatial index */
+    std::vector<int> visibleCells, visibleDiscs;
     int selectedRect1x,selectedRect1y,selectedRect2x,selectedRect2y;
     int spaceCounter;
     bool rectSelect;
@@ -141,7 +263,10 @@ class MyPanZoomWindow : public PanZoomWindow
 	int x;
 	int y;
 	} ZJW_point;    
-    } panZoomWindow (PLAY_FIELD[0],PLAY_FIELD[1]);
+    };
+
+/** the window is created in 'main' once the scene has been read from the command line */
+static MyPanZoomWindow* panZoomWindow;
 
 /*******************************************************************************
     File Scope (static) Functions
@@ -149,158 +274,340 @@ class MyPanZoomWindow : public PanZoomWindow
 using namespace ITCS4120::OpenGLTrainer;
 
 /**
-\brief Construct a PanZoomWindow whose view window is initially bounded by 'viewLowerLeft' and
-'viewUpperRight'.
+\brief 'CompileShader' compiles 'source' as a shader of 'type', printing the log on failure.
+*/
+static GLuint CompileShader (GLenum type, const char* source)
+    {
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader,1,&source,0);
+    glCompileShader(shader);
+    GLint status = GL_FALSE;
+    glGetShaderiv(shader,GL_COMPILE_STATUS,&status);
+    if (status != GL_TRUE)
+	{
+	char log[1024];
+	glGetShaderInfoLog(shader,sizeof(log),0,log);
+	cout << "shader compilation failed: " << log << endl;
+	}
+    return shader;
+    }
+
+/**
+\brief 'CompileProgram' links a program from the sources of a vertex and a fragment shader.
+*/
+static GLuint CompileProgram (const char* vertexSource, const char* fragmentSource)
+    {
+    GLuint program = glCreateProgram();
+    GLuint vertexShader = CompileShader(GL_VERTEX_SHADER,vertexSource);
+    GLuint fragmentShader = CompileShader(GL_FRAGMENT_SHADER,fragmentSource);
+    glAttachShader(program,vertexShader);
+    glAttachShader(program,fragmentShader);
+    glLinkProgram(program);
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+    GLint status = GL_FALSE;
+    glGetProgramiv(program,GL_LINK_STATUS,&status);
+    if (status != GL_TRUE)
+	{
+	char log[1024];
+	glGetProgramInfoLog(program,sizeof(log),0,log);
+	cout << "shader link failed: " << log << endl;
+	}
+    return program;
+    }
+
+/**
+\brief 'FillInstance' copies disc 'i' of 'discs' to 'instance'; a dead disc gets radius 0.
 */
-MyPanZoomWindow::MyPanZoomWindow (const float viewLowerLeft[2], const float viewUpperRight[2]) : 
-	PanZoomWindow (viewLowerLeft,viewUpperRight)
+static void FillInstance (const DiscSet& discs, int i, DiscInstance& instance)
+    {
+    instance.x = discs.x()[i];
+    instance.y = discs.y()[i];
+    instance.radius = discs.alive()[i] ? discs.radius()[i] : 0;
+    instance.colour = discs.colour()[i];
+    }
+
+/**
+\brief Construct a PanZoomWindow whose view window is initially bounded by the play field
+of 'scene' and populate the field and the index as described by 'scene' and 'options'.
+*/
+MyPanZoomWindow::MyPanZoomWindow (const SceneDescription& scene, const DemoOptions& options) : 
+	PanZoomWindow (scene.field[0],scene.field[1]), collider(scene,options.backend)
     {
     firstDisplay = true;
+    firstSelect = false;
+    secondSelect = false;
     firstClick=true;
+    ZJW_drag = false;
+    ZJW_point.x = ZJW_point.y = 0;
+    selectedRect1x = selectedRect1y = selectedRect2x = selectedRect2y = 0;
     highlightDiscs = false;
     deleteDiscs=false;
-    cell_width=1000;
-    cell_height=1000;
-    disc_radius=250;
+    circleBuffer = discBuffer = visibleBuffer = discProgram = 0;
+    cornerAttribute = discAttribute = colourAttribute = pixelsPerUnitUniform = -1;
+    discBufferSize = 0;
+    allDiscsDirty = true;
     spaceCounter=1;
-    for(int i=0;i<100000;i++)
-	{
-	discs[i].rvalue=0.2;
-	discs[i].gvalue=0.8;
-	discs[i].bvalue=0.2;
-	}
-	Initialize();
-	GenerateDiscs();
-	InsertDiscs();
+    selectionEpoch = 0;
+    collider.generate((unsigned)time(0));
+    if (options.sortDiscs)
+	collider.sortDiscs();
+    std::vector<int> all(collider.discs().size());
+    for(int i=0;i<(int)all.size();i++)
+	all[i]=i;
+    ColourDiscs(all,0.2,0.8,0.2);
     }
 
-GLuint MyPanZoomWindow::createDL() {
-	GLuint listID;
-
-	listID = glGenLists(1);
-	
-	glNewList(listID,GL_COMPILE);
-	
-	for(int i=0;i<100000;i++)
+/**
+\brief 'createDiscBuffers' compiles the disc shaders, fills the unit circle buffer and
+uploads every disc to the instance buffer.
+*/
+void MyPanZoomWindow::createDiscBuffers ()
+    {
+    discProgram = CompileProgram(DISC_VERTEX_SHADER,DISC_FRAGMENT_SHADER);
+    cornerAttribute = glGetAttribLocation(discProgram,"corner");
+    discAttribute = glGetAttribLocation(discProgram,"disc");
+    colourAttribute = glGetAttribLocation(discProgram,"colour");
+    pixelsPerUnitUniform = glGetUniformLocation(discProgram,"pixelsPerUnit");
+
+    std::vector<float> circle;
+    for (int l=0; l<DISC_LOD_COUNT && DISC_LODS[l].segments>0; l++)
+	{
+	circle.push_back(0);
+	circle.push_back(0);
+	const int step = 36/DISC_LODS[l].segments;
+	for (int k=0; k<=36; k+=step)
 	    {
-	    glPushMatrix();
-	    glColor3f(discs[i].rvalue,discs[i].gvalue,discs[i].bvalue);
-	    MyPanZoomWindow::DrawDiscs(discs[i].x,discs[i].y);
-	    glPopMatrix();
+	    circle.push_back(UNIT_CIRCLE[k][0]);
+	    circle.push_back(UNIT_CIRCLE[k][1]);
 	    }
-	glEndList();
-
-	return(listID);
-}
+	}
+    glGenBuffers(1,&circleBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER,circleBuffer);
+    glBufferData(GL_ARRAY_BUFFER,circle.size()*sizeof(float),&circle[0],GL_STATIC_DRAW);
+
+    glGenBuffers(1,&discBuffer);
+    glGenBuffers(1,&visibleBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER,0);
+    allDiscsDirty = true;
+    uploadDiscs();
+    }
 
-void MyPanZoomWindow::Initialize()
-    {	    
-	    for(int y=0;y<1000;y++)
-		{
-		for(int x=0;x<1000;x++)
-		    {
-		    playGrid[x][y].x=x*1000;
-		    playGrid[x][y].y=y*1000;
-		    playGrid[x][y].noDiscs=0;
-		    }
-		}
-         }
+/**
+\brief 'uploadDiscs' copies the changed discs to the instance buffer.
 
-void MyPanZoomWindow::GenerateDiscs()
+The dirty discs are sorted and uploaded as ranges, merging those less than DIRTY_RANGE_GAP
+apart, so the cost follows the number of changed discs.  After the discs were renumbered or
+their number changed, the whole buffer is reloaded.
+*/
+void MyPanZoomWindow::uploadDiscs ()
     {
-    srand(time(0));
-    for(int i=0;i<100000;i++)
+    const DiscSet& discs = collider.discs();
+    glBindBuffer(GL_ARRAY_BUFFER,discBuffer);
+    if (allDiscsDirty || discBufferSize != discs.size())
 	{
-	discs[i].x= (rand()*32 % 1000000) + rand()%32;
-	discs[i].y= (rand()*32 % 1000000) + rand()%32;
-	
+	dirtyDiscs.resize(discs.size());
+	for (int i=0; i<discs.size(); i++)
+	    dirtyDiscs[i] = i;
+	discBufferSize = discs.size();
+	glBufferData(GL_ARRAY_BUFFER,discBufferSize*sizeof(DiscInstance),0,GL_DYNAMIC_DRAW);
+	allDiscsDirty = false;
+	}
+    sort(dirtyDiscs.begin(),dirtyDiscs.end());
+    dirtyDiscs.erase(unique(dirtyDiscs.begin(),dirtyDiscs.end()),dirtyDiscs.end());
+
+    for (size_t i=0; i<dirtyDiscs.size(); )
+	{
+	/* the range [first,last] of discs to copy */
+	const int first = dirtyDiscs[i];
+	int last = first;
+	for (i++; i<dirtyDiscs.size() && dirtyDiscs[i]-last <= DIRTY_RANGE_GAP; i++)
+	    last = dirtyDiscs[i];
+	discInstances.resize(last-first+1);
+	for (int j=first; j<=last; j++)
+	    FillInstance(discs,j,discInstances[j-first]);
+	glBufferSubData(GL_ARRAY_BUFFER,first*sizeof(DiscInstance),
+	    discInstances.size()*sizeof(DiscInstance),&discInstances[0]);
 	}
+    dirtyDiscs.clear();
+    glBindBuffer(GL_ARRAY_BUFFER,0);
     }
 
-void MyPanZoomWindow::DrawDiscs (float cx,float cy)
+/**
+\brief 'CullDiscs' finds the discs in the view window and copies them to 'visibleBuffer',
+returning their number, or returns -1 when the view window covers so much of the field
+(CULL_VIEW_FRACTION) that every disc should be drawn from 'discBuffer'.
+
+The discs in view are those of the spatial index cells the view window overlaps, so the
+cost follows what is visible rather than the number of discs.
+*/
+int MyPanZoomWindow::CullDiscs ()
     {
-    // draw a circle centered at (xc,yc) with radius disc_radius
-    
-	glBegin(GL_TRIANGLE_FAN);
-	glVertex2f(cx,cy);
-	for (int angle=0; angle<=360; angle=angle+20)
-	    {
-	    float angle_radians = angle * (float)3.14159 / (float)180;
-	    float x = cx + disc_radius * (float)cos(angle_radians);
-	    float y = cy + disc_radius * (float)sin(angle_radians);
-	    glVertex2f(x,y);
-	    }
-	glEnd();
+    const ViewWindow& view = viewWindow();
+    const float (&field)[2][2] = collider.scene().field;
+    const float x0 = max(view.lowerLeft[0],field[0][0]), x1 = min(view.upperRight[0],field[1][0]);
+    const float y0 = max(view.lowerLeft[1],field[0][1]), y1 = min(view.upperRight[1],field[1][1]);
+    if (x0 >= x1 || y0 >= y1)
+	return 0;
+    const float fieldArea = (field[1][0] - field[0][0])*(field[1][1] - field[0][1]);
+    if ((x1 - x0)*(y1 - y0) >= CULL_VIEW_FRACTION*fieldArea)
+	return -1;
+
+    /* the view window as a box swept from its left edge to its right edge */
+    const float yc = (y0 + y1)/2;
+    collider.index().boxCandidates(SweptBox(x0,yc,x1,yc,(y1 - y0)/2),visibleCells,visibleDiscs);
+    const DiscSet& discs = collider.discs();
+    discInstances.resize(visibleDiscs.size());
+    for (size_t i=0; i<visibleDiscs.size(); i++)
+	FillInstance(discs,visibleDiscs[i],discInstances[i]);
+    glBindBuffer(GL_ARRAY_BUFFER,visibleBuffer);
+    glBufferData(GL_ARRAY_BUFFER,discInstances.size()*sizeof(DiscInstance),
+	discInstances.empty() ? 0 : &discInstances[0],GL_STREAM_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER,0);
+    return (int)visibleDiscs.size();
     }
 
-void MyPanZoomWindow::InsertDiscs()
+/**
+\brief 'DrawDiscs' draws every disc as an instance of the unit circle fan.  Without
+instanced arrays (OpenGL 3.3) the instances are drawn one by one from the same shader.
+Only the discs in view are drawn (see CullDiscs).  The discs changed since the last frame
+are uploaded first, so 'discBuffer' holds the same colours that CullDiscs reads.
+
+The fan is the coarsest of DISC_LODS that still suits the largest disc at the current zoom
+of the view window, down to a single point sized to the disc when it covers a pixel or two.
+*/
+void MyPanZoomWindow::DrawDiscs ()
     {
-    int gx,gy,tempx,tempy,j;
-    for(int i=0;i<100000;i++)	    //For each disc
+    const ViewWindow& view = viewWindow();
+    const float pixelsPerUnit = width/(view.upperRight[0] - view.lowerLeft[0]);
+    const SceneDescription& scene = collider.scene();
+    const float radiusPixels = max(scene.discRadius,scene.maxDiscRadius)*pixelsPerUnit;
+    int lod = 0;
+    GLint first = 0;
+    while (lod<DISC_LOD_COUNT-1 && radiusPixels<DISC_LODS[lod].minPixels)
+	first += DISC_LODS[lod++].segments + 2;
+    const GLenum mode = DISC_LODS[lod].segments>0 ? GL_TRIANGLE_FAN : GL_POINTS;
+    const GLsizei count = DISC_LODS[lod].segments>0 ? DISC_LODS[lod].segments + 2 : 1;
+    if (mode == GL_POINTS)
+	first = 0;
+    if (allDiscsDirty || !dirtyDiscs.empty() || discBufferSize != collider.discs().size())
+	uploadDiscs();
+    const int visible = CullDiscs();
+
+    glUseProgram(discProgram);
+    glUniform1f(pixelsPerUnitUniform,pixelsPerUnit);
+    glEnable(GL_VERTEX_PROGRAM_POINT_SIZE);
+    glBindBuffer(GL_ARRAY_BUFFER,circleBuffer);
+    glEnableVertexAttribArray(cornerAttribute);
+    glVertexAttribPointer(cornerAttribute,2,GL_FLOAT,GL_FALSE,0,0);
+    if (GLEW_VERSION_3_3)
 	{
-	    //calculate the location (lower left corner) of the cell in which the disc lies 
-	tempx=discs[i].x - discs[i].x % cell_width;
-	tempy=discs[i].y - discs[i].y % cell_height;
-			
-
-	gx=tempx/1000;		    //calculate the cell array index ,gx and gy, in which to insert the disc
-	gy=tempy/1000;
-	
-	j=playGrid[gx][gy].noDiscs;
-			//store the pointer to the disc in the grid datastructure
-	playGrid[gx][gy].containedDiscs[j]=&discs[i];
-	playGrid[gx][gy].noDiscs++;
-			//Check if disc also lies in adjacent cells
-	if(discs[i].x + disc_radius >= tempx + cell_width && gx<999)	    //right cell
-	    {
-	    j=playGrid[gx+1][gy].noDiscs;
-	    playGrid[gx+1][gy].containedDiscs[j]=&discs[i];
-	    playGrid[gx+1][gy].noDiscs++;
-	    }
-	if(discs[i].x - disc_radius < tempx && gx>0)		    //left cell
-	    {
-	    j=playGrid[gx-1][gy].noDiscs;
-	    playGrid[gx-1][gy].containedDiscs[j]=&discs[i];
-	    playGrid[gx-1][gy].noDiscs++;
-	    }
-	if(discs[i].y + disc_radius >= tempy + cell_height && gy<999)		    //top cell
-	    {
-	    j=playGrid[gx][gy+1].noDiscs;			    
-	    playGrid[gx][gy+1].containedDiscs[j]=&discs[i];
-	    playGrid[gx][gy+1].noDiscs++;
-	    }
-	if(discs[i].y - disc_radius < tempy && gy>0)		    //bottom cell
-	    {
-	    j=playGrid[gx][gy-1].noDiscs;			    
-	    playGrid[gx][gy-1].containedDiscs[j]=&discs[i];
-	    playGrid[gx][gy-1].noDiscs++;
-	    }
-	if(discs[i].x + disc_radius/(sqrtf(2)) >= tempx + cell_width && discs[i].y + disc_radius/(sqrtf(2)) >= tempy + cell_height  && gy<999 && gx<999)		    //top right cell
-	    {
-	    j=playGrid[gx+1][gy+1].noDiscs;			    
-	    playGrid[gx+1][gy+1].containedDiscs[j]=&discs[i];
-	    playGrid[gx+1][gy+1].noDiscs++;
-	    }
-	if(discs[i].x - disc_radius/(sqrtf(2)) < tempx && discs[i].y + disc_radius/(sqrtf(2)) >= tempy + cell_height  && gy<999 && gx>0)		    //top left cell
+	glBindBuffer(GL_ARRAY_BUFFER,visible<0 ? discBuffer : visibleBuffer);
+	glEnableVertexAttribArray(discAttribute);
+	glEnableVertexAttribArray(colourAttribute);
+	glVertexAttribPointer(discAttribute,3,GL_FLOAT,GL_FALSE,sizeof(DiscInstance),0);
+	glVertexAttribPointer(colourAttribute,4,GL_UNSIGNED_BYTE,GL_TRUE,sizeof(DiscInstance),
+	    (const GLvoid*)(3*sizeof(float)));
+	glVertexAttribDivisor(discAttribute,1);
+	glVertexAttribDivisor(colourAttribute,1);
+	glDrawArraysInstanced(mode,first,count,visible<0 ? discBufferSize : visible);
+	glVertexAttribDivisor(discAttribute,0);
+	glVertexAttribDivisor(colourAttribute,0);
+	glDisableVertexAttribArray(discAttribute);
+	glDisableVertexAttribArray(colourAttribute);
+	}
+    else
+	{
+	const DiscSet& discs = collider.discs();
+	for (int k=0; k<(visible<0 ? discs.size() : visible); k++)
 	    {
-	    j=playGrid[gx-1][gy+1].noDiscs;			    
-	    playGrid[gx-1][gy+1].containedDiscs[j]=&discs[i];
-	    playGrid[gx-1][gy+1].noDiscs++;
+	    const int i = visible<0 ? k : visibleDiscs[k];
+	    if (!discs.alive()[i])
+		continue;
+	    const unsigned colour = discs.colour()[i];
+	    glVertexAttrib3f(discAttribute,discs.x()[i],discs.y()[i],discs.radius()[i]);
+	    glVertexAttrib4Nub(colourAttribute,colour & 0xFF,(colour >> 8) & 0xFF,(colour >> 16) & 0xFF,0xFF);
+	    glDrawArrays(mode,first,count);
 	    }
-	if(discs[i].x - disc_radius/(sqrtf(2)) < tempx && discs[i].y - disc_radius/(sqrtf(2)) < tempy && gy>0 && gx>0)		    //bottom left cell
+	}
+    glDisableVertexAttribArray(cornerAttribute);
+    glBindBuffer(GL_ARRAY_BUFFER,0);
+    glDisable(GL_VERTEX_PROGRAM_POINT_SIZE);
+    glUseProgram(0);
+    }
+
+/**
+\brief 'SelectCells' runs the swept box query from the cell with lower left corner
+(cell1x,cell1y) to the one at (cell2x,cell2y) into 'selection' and lays out the quads of
+the cells it reports in 'selectionCellVertices'.  ZJW_draw_frame calls it only when the
+selected cells or the collider's epoch() change, so redraws cost no query.
+*/
+void MyPanZoomWindow::SelectCells (int cell1x, int cell1y, int cell2x, int cell2y)
+    {
+    const UniformGrid& grid=collider.grid();
+    /* sweep the whole first cell to the second:  the box follows the line through the cell
+       centres, as wide as a cell seen across the motion and reaching on past each centre
+       as far as a cell reaches along it, so both end cells lie inside it */
+    const float halfX=grid.cellWidth()/2.0f, halfY=grid.cellHeight()/2.0f;
+    const float dx=cell2x-cell1x, dy=cell2y-cell1y;
+    const float length=sqrt(dx*dx + dy*dy);
+    const float ux= length>0 ? dx/length : 1, uy= length>0 ? dy/length : 0;
+    const float reach=halfX*fabs(ux) + halfY*fabs(uy);
+    const float halfWidth=halfX*fabs(uy) + halfY*fabs(ux);
+    collider.sweptBoxQuery(cell1x + halfX - reach*ux,cell1y + halfY - reach*uy,
+	cell2x + halfX + reach*ux,cell2y + halfY + reach*uy,halfWidth,selection);
+
+    selectionCellVertices.resize(selection.cells.size()*12);
+    float* v=selectionCellVertices.empty() ? 0 : &selectionCellVertices[0];
+    for(int i=0;i<(int)selection.cells.size();i++,v+=12)
+	{
+	const int c=selection.cells[i];
+	const float x=grid.cellX(c % grid.columns()), y=grid.cellY(c / grid.columns());
+	const float corners[4][2]={{0,0},{1,0},{1,1},{0,1}};
+	for(int k=0;k<4;k++)
 	    {
-	    j=playGrid[gx-1][gy-1].noDiscs;			    
-	    playGrid[gx-1][gy-1].containedDiscs[j]=&discs[i];
-	    playGrid[gx-1][gy-1].noDiscs++;
+	    v[3*k]=x + corners[k][0]*grid.cellWidth();
+	    v[3*k+1]=y + corners[k][1]*grid.cellHeight();
+	    v[3*k+2]=1;
 	    }
-	if(discs[i].x + disc_radius/(sqrtf(2)) >= tempx + cell_width && discs[i].y - disc_radius/(sqrtf(2)) < tempy && gy>0 && gx<999)		    //bottom right cell
+	}
+    selectionKey[0]=cell1x;
+    selectionKey[1]=cell1y;
+    selectionKey[2]=cell2x;
+    selectionKey[3]=cell2y;
+    selectionEpoch=collider.epoch();
+    }
+
+/**
+\brief 'DrawSelectedCells' fills the cells of the selection with one vertex array draw.
+*/
+void MyPanZoomWindow::DrawSelectedCells ()
+    {
+    if(selectionCellVertices.empty())
+	return;
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(3,GL_FLOAT,0,&selectionCellVertices[0]);
+    glDrawArrays(GL_QUADS,0,(GLsizei)selectionCellVertices.size()/3);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    }
+
+/**
+\brief 'ColourDiscs' sets the colour of the discs 'ids', packed as 0xAABBGGRR, and marks
+the discs whose colour changed for the next uploadDiscs.
+*/
+void MyPanZoomWindow::ColourDiscs (const std::vector<int>& ids, float r, float g, float b)
+    {
+    const unsigned colour=0xFF000000u
+	| (unsigned)(b*255 + 0.5f) << 16
+	| (unsigned)(g*255 + 0.5f) << 8
+	| (unsigned)(r*255 + 0.5f);
+    unsigned* discColours=collider.colour();
+    for(int i=0;i<(int)ids.size();i++)
+	if(discColours[ids[i]]!=colour)
 	    {
-	    j=playGrid[gx+1][gy-1].noDiscs;			    
-	    playGrid[gx+1][gy-1].containedDiscs[j]=&discs[i];
-	    playGrid[gx+1][gy-1].noDiscs++;
+	    discColours[ids[i]]=colour;
+	    dirtyDiscs.push_back(ids[i]);
 	    }
-
-	}
     }
 
 /**
@@ -402,7 +709,7 @@ void MyPanZoomWindow::display(void)
     if (firstDisplay)
 	{
 	resetOpenGL();
-	discID=createDL();
+	createDiscBuffers();
 	firstDisplay = false;
 	}
 
@@ -429,18 +736,27 @@ void MyPanZoomWindow::display(void)
 // \brief draw some random stuff
 void MyPanZoomWindow::ZJW_draw_frame()
     {
+    const UniformGrid& grid = collider.grid();
+    const float (&PLAY_FIELD)[2][2] = collider.scene().field;
+    const int cell_width = grid.cellWidth();
+    const int cell_height = grid.cellHeight();
     const int WIDTH = PLAY_FIELD[1][0]-PLAY_FIELD[0][0];
     const int HEIGHT = PLAY_FIELD[1][1]-PLAY_FIELD[0][1];
     const int CENTER_X = WIDTH/2;
     const int CENTER_Y = HEIGHT/2;
+    /* lower left corners of the selected cells */
+    const int cell1x = grid.cellX(selectedRect1x);
+    const int cell1y = grid.cellY(selectedRect1y);
+    const int cell2x = grid.cellX(selectedRect2x);
+    const int cell2y = grid.cellY(selectedRect2y);
 
     /* draw play field */
     glColor3ub(120,120,200);
     glBegin(GL_QUADS);
 	glVertex2fv(PLAY_FIELD[0]);
-	glVertex2f (PLAY_FIELD[1][0],PLAY_FIELD[0][0]);
+	glVertex2f (PLAY_FIELD[1][0],PLAY_FIELD[0][1]);
 	glVertex2fv(PLAY_FIELD[1]);
-	glVertex2f (PLAY_FIELD[0][0],PLAY_FIELD[1][0]);
+	glVertex2f (PLAY_FIELD[0][0],PLAY_FIELD[1][1]);
     glEnd();
    
 //Draw Selected Cells..
@@ -449,89 +765,88 @@ void MyPanZoomWindow::ZJW_draw_frame()
     if(firstSelect==true)
 	{
 	glBegin(GL_POLYGON);
-	glVertex2i(playGrid[selectedRect1x][selectedRect1y].x,playGrid[selectedRect1x][selectedRect1y].y);
-	glVertex2i(playGrid[selectedRect1x][selectedRect1y].x + cell_width,playGrid[selectedRect1x][selectedRect1y].y);
+	glVertex2i(cell1x,cell1y);
+	glVertex2i(cell1x + cell_width,cell1y);
 
-	glVertex2i(playGrid[selectedRect1x][selectedRect1y].x + cell_width,playGrid[selectedRect1x][selectedRect1y].y + cell_height);
-	glVertex2i(playGrid[selectedRect1x][selectedRect1y].x,playGrid[selectedRect1x][selectedRect1y].y + cell_height);
+	glVertex2i(cell1x + cell_width,cell1y + cell_height);
+	glVertex2i(cell1x,cell1y + cell_height);
 	glEnd();
 	}
     if(secondSelect==true)
 	{
 	glBegin(GL_POLYGON);
-	glVertex2i(playGrid[selectedRect2x][selectedRect2y].x,playGrid[selectedRect2x][selectedRect2y].y);
-	glVertex2i(playGrid[selectedRect2x][selectedRect2y].x + cell_width,playGrid[selectedRect2x][selectedRect2y].y);
+	glVertex2i(cell2x,cell2y);
+	glVertex2i(cell2x + cell_width,cell2y);
 
-	glVertex2i(playGrid[selectedRect2x][selectedRect2y].x + cell_width,playGrid[selectedRect2x][selectedRect2y].y + cell_height);
-	glVertex2i(playGrid[selectedRect2x][selectedRect2y].x,playGrid[selectedRect2x][selectedRect2y].y + cell_height);
+	glVertex2i(cell2x + cell_width,cell2y + cell_height);
+	glVertex2i(cell2x,cell2y + cell_height);
 	glEnd();
 	}
 
 
-    //Highlight all cells intersected by the line segment
+    //Highlight all cells intersected by the swept cell
     if(firstSelect==true && secondSelect==true)
 	{
-	int dx = (playGrid[selectedRect2x][selectedRect2y].x - playGrid[selectedRect1x][selectedRect1y].x);
-	int dy = (playGrid[selectedRect2x][selectedRect2y].y - playGrid[selectedRect1x][selectedRect1y].y);
-	if((dy>=0 && dx >=0) || (dy<0 && dx<0))
+	const bool selectionChanged = selectionEpoch!=collider.epoch()
+	    || selectionKey[0]!=cell1x || selectionKey[1]!=cell1y
+	    || selectionKey[2]!=cell2x || selectionKey[3]!=cell2y;
+	if(selectionChanged)
+	    SelectCells(cell1x,cell1y,cell2x,cell2y);
+	/* recolour only for a new selection or a key press, not on every redraw */
+	if(selectionChanged || highlightDiscs==true || deleteDiscs==true)
 	    {
-	    glColor4f(0.6,0.1,0.1,0.2);
-	SelectIntersectedCells(playGrid[selectedRect1x][selectedRect1y].x + cell_width,playGrid[selectedRect1x][selectedRect1y].y, playGrid[selectedRect2x][selectedRect2y].x + cell_width,playGrid[selectedRect2x][selectedRect2y].y,true);
-	glColor4f(0.3,0.3,0.7,0.2);
-	SelectIntersectedCells(playGrid[selectedRect2x][selectedRect2y].x, playGrid[selectedRect2x][selectedRect2y].y + cell_height, playGrid[selectedRect1x][selectedRect1y].x, playGrid[selectedRect1x][selectedRect1y].y + cell_height,false);
-	
+	    if(highlightDiscs==true)
+		ColourDiscs(selection.candidates,0.858824,0.439216,0.858824);
+	    else
+		ColourDiscs(selection.candidates,0.2,0.8,0.2);
+	    }
+	if(deleteDiscs==true)
+	    {
+	    collider.removeHits(selection);
+	    dirtyDiscs.insert(dirtyDiscs.end(),selection.hits.begin(),selection.hits.end());
+	    }
+
+	glColor4f(0.6,0.1,0.1,0.2);
+	DrawSelectedCells();
+
 	glColor3ub(20,10,50);
 	glLineWidth(2);
 	glBegin(GL_LINE_LOOP);
-	glVertex2i(playGrid[selectedRect1x][selectedRect1y].x + cell_width,playGrid[selectedRect1x][selectedRect1y].y );
-	glVertex2i(playGrid[selectedRect2x][selectedRect2y].x + cell_width,playGrid[selectedRect2x][selectedRect2y].y);
-	glVertex2i(playGrid[selectedRect2x][selectedRect2y].x, playGrid[selectedRect2x][selectedRect2y].y + cell_height);
-	glVertex2i(playGrid[selectedRect1x][selectedRect1y].x, playGrid[selectedRect1x][selectedRect1y].y + cell_height);
+	for(int i=0;i<4;i++)
+	    glVertex2fv(selection.corners[i]);
 	glEnd();
-	    }
-	else
-	    {
-	    glColor4f(0.6,0.1,0.1,0.2);
-	    SelectIntersectedCells(playGrid[selectedRect1x][selectedRect1y].x, playGrid[selectedRect1x][selectedRect1y].y, playGrid[selectedRect2x][selectedRect2y].x,playGrid[selectedRect2x][selectedRect2y].y, true);
-	    glColor4f(0.3,0.3,0.7,0.2);
-	    SelectIntersectedCells(playGrid[selectedRect2x][selectedRect2y].x + cell_width, playGrid[selectedRect2x][selectedRect2y].y + cell_height, playGrid[selectedRect1x][selectedRect1y].x + cell_width, playGrid[selectedRect1x][selectedRect1y].y + cell_height, false);
-	    
-	    glColor3ub(20,10,50);
-	    glLineWidth(2);
-	    glBegin(GL_LINE_LOOP);
-	    glVertex2i(playGrid[selectedRect1x][selectedRect1y].x, playGrid[selectedRect1x][selectedRect1y].y);
-	    glVertex2i(playGrid[selectedRect2x][selectedRect2y].x, playGrid[selectedRect2x][selectedRect2y].y);
-	    glVertex2i(playGrid[selectedRect2x][selectedRect2y].x + cell_width, playGrid[selectedRect2x][selectedRect2y].y + cell_height);
-	    glVertex2i(playGrid[selectedRect1x][selectedRect1y].x + cell_width, playGrid[selectedRect1x][selectedRect1y].y + cell_height);
-	    glEnd();
-	    }
 	}
 
-       //draw Grid
+       //draw Grid, only the lines within the view window
+    const ViewWindow& view = viewWindow();
+    const float viewX0 = max(view.lowerLeft[0],PLAY_FIELD[0][0]);
+    const float viewX1 = min(view.upperRight[0],PLAY_FIELD[1][0]);
+    const float viewY0 = max(view.lowerLeft[1],PLAY_FIELD[0][1]);
+    const float viewY1 = min(view.upperRight[1],PLAY_FIELD[1][1]);
     glColor3ub(20,20,100);
     glLineWidth(2);
     glBegin(GL_LINES);
-    for(int i=0;i<=999000;i+=1000)
+    for(int i=grid.cellColumn(viewX0);i<=grid.cellColumn(viewX1);i++)
 	{
-	glVertex2f(i,0);
-	glVertex2f(i,1e6);
+	glVertex2f(grid.cellX(i),viewY0);
+	glVertex2f(grid.cellX(i),viewY1);
 	}
-    for(int j=0;j<=999000;j+=1000)
+    for(int j=grid.cellRow(viewY0);j<=grid.cellRow(viewY1);j++)
 	{
-	glVertex2f(0,j);
-	glVertex2f(1e6,j);
+	glVertex2f(viewX0,grid.cellY(j));
+	glVertex2f(viewX1,grid.cellY(j));
 	}
     glEnd();
     glLineWidth(1);
 
-    if(highlightDiscs==true || deleteDiscs==true)
-	{
-	discID=createDL();
-	deleteDiscs=false;
-	highlightDiscs=false;
-	}
+    deleteDiscs=false;
+    highlightDiscs=false;
     //Draw discs
-    glCallList(discID);
+    DrawDiscs();
+    /* the frame holds no disc ids now but 'selection', which the epoch check redoes, so
+       this is where the removed discs are compacted away */
+    if(collider.compactIfSparse(renumbered))
+	allDiscsDirty=true;
 
     /* draw X at center of field */
     /*glLineWidth(1);
@@ -554,284 +869,12 @@ void MyPanZoomWindow::ZJW_draw_frame()
     //***************My Code*******************
    
     }
-void MyPanZoomWindow::SelectIntersectedCells(int p1x, int p1y, int p2x, int p2y, bool bline)
-{
-    int F, x, y;
-
-    if (p1x > p2x)  // Swap points if p1 is on the right of p2
-    {
-        swap(p1x, p2x);
-        swap(p1y, p2y);
-    }
-
-    // Handle trivial cases separately
-    //case 1: Vertical line
-    if (p1x == p2x)
-    {
-        if (p1y > p2y)  // Swap y-coordinates if p1 is above p2
-        {
-            swap(p1y, p2y);
-        }
-
-        x = p1x;
-        y = p1y;
-        while (y <= p2y)
-        {
-            setPixel(x, y, p1x,p1y,p2x,p2y, bline);
-            y++;
-        }
-        return;
-    }
-    // Horizontal line
-    else if (p1y == p2y)
-    {
-        x = p1x;
-        y = p1y;
-
-        while (x <= p2x)
-        {
-            setPixel(x, y, p1x, p1y, p2x,p2y, bline);
-            x++;
-        }
-        return;
-    }
-
-    int dy            = p2y - p1y;  // y-increment from p1 to p2
-    int dx            = p2x - p1x;  // x-increment from p1 to p2
-    int dy2           = 2*dy;
-    int dx2           = 2*dx;
-
-    if (dy >= 0)    // m >= 0
-    {
-        // Case 1: 0 <= m <= 1 (Original case)
-        if (dy <= dx)   
-        {
-            F = dy - dx;    // initial F
-
-            x = p1x;
-            y = p1y;
-            while (x < p2x)
-            {
-		//x++;
-		//y++;
-                 setPixel(x, y, p1x, p1y, p2x,p2y, bline);
-
-
-                if (F > 0)
-                {   
-		    y+=1000;
-                    F = F - dx;
-                }
-                else if(F < 0)
-                {
-                    x+=1000;
-                    F = F + dy;
-                }
-		else
-                {
-                    y+=1000;
-		    x+=1000;
-                    F = F + dy - dx;
-                }
-		
-            }
-        }
-        // Case 2: 1 < m < INF (Mirror about y=x line
-        // replace all dy by dx and dx by dy)
-        else
-        {
-            F = dx - dy;    // initial F
-
-            y = p1y;
-            x = p1x;
-            while (y < p2y)
-            {
-                 setPixel(x, y, p1x, p1y, p2x,p2y, bline);
-                if (F > 0)
-                {
-		    x+=1000;
-                    F -= dy;
-                }
-               else if(F<0)
-                {
-                    y+=1000;
-                    F += dx;
-                }
-                else
-		    {
-		    x+=1000;
-		    y+=1000;
-		    F = F + dx - dy;
-		    }
-            }
-        }
-    }
-    else    // m < 0
-    {
-        // Case 3: -1 <= m < 0 (Mirror about x-axis, replace all dy by -dy)
-        if (dx >= -dy)
-        {
-            F = -dy - dx;    // initial F
-
-            x = p1x;
-            y = p1y;
-            while (x < p2x)
-            {
-		//setPixel(x, y);
-                if (F < 0)
-                {
-		    x+=1;
-		     setPixel(x, y, p1x, p1y, p2x,p2y, bline);
-                    F = F - dy;
-                }
-                else if(F>0)
-                {
-                    y-=1;
-		     setPixel(x, y, p1x, p1y, p2x,p2y, bline);
-                    F = F - dx;
-                }
-		else
-		{
-		    
-		    x+=1;
-		    y-=1;
-		    if(x%1000!=0 && y%1000!=0)
-			 setPixel(x, y, p1x, p1y, p2x,p2y, bline);
-		    F = F - dy - dx;
-		}
-		
-            }
-        }
-        // Case 4: -INF < m < -1 (Mirror about x-axis and mirror 
-        // about y=x line, replace all dx by -dy and dy by dx)
-        else    
-        {
-            F = dx + dy;    // initial F
-
-            y = p1y;
-            x = p1x;
-            while (y > p2y)
-            {
-	        //setPixel(x,y);
-                if (F < 0)
-                {
-		    y-=1;
-		      setPixel(x, y, p1x, p1y, p2x,p2y, bline);
-                    F += dx;
-                }
-                else if(F>0)
-                {
-                    x+=1;
-		      setPixel(x, y, p1x, p1y, p2x,p2y, bline);
-                    F += dy;
-                }
-		else
-		{
-		 setPixel(x, y, p1x, p1y, p2x,p2y, bline);
-                y-=1;
-		x+=1;
-		
-		F = F + dy + dx;
-		}
-		
-            }
-
-        }
-    }
-}
-void MyPanZoomWindow::setPixel(int px, int py, int x1, int y1, int x2, int y2, bool bline)
-{
-    int x=px-px%1000;
-    int y=py-py%1000;
-    glBegin(GL_POLYGON);
-    glVertex3i(x,y,1);
-    glVertex3i(x + cell_width, y,1);
-    glVertex3i(x + cell_width, y + cell_height,1);
-    glVertex3i(x, y + cell_height,1);
-    glEnd();
-    playGrid[x/1000][y/1000].selected=true;
-    int gx=x/1000;
-    int gy=y/1000;
-    int i=0;
-    if(playGrid[gx][gy].noDiscs!=0)
-	{
-      if(highlightDiscs==true)
-	   { 	
-	    for(i=0; i<playGrid[gx][gy].noDiscs; i++)
-		{
-		playGrid[gx][gy].containedDiscs[i]->rvalue=0.858824;
-		playGrid[gx][gy].containedDiscs[i]->gvalue=0.439216;
-		playGrid[gx][gy].containedDiscs[i]->bvalue=0.858824;
-		}
-	    }
-      else
-	  {	for(i=0; i<playGrid[gx][gy].noDiscs; i++)
-		{
-		playGrid[gx][gy].containedDiscs[i]->rvalue=0.2;
-		playGrid[gx][gy].containedDiscs[i]->gvalue=0.8;
-		playGrid[gx][gy].containedDiscs[i]->bvalue=0.2;
-		}
-	  }
-	if(deleteDiscs==true)
-	    {
-	    int n = playGrid[gx][gy].noDiscs;
-	    for(int i=0; i < n; i++)
-		{
-		DeleteIntersectedDiscs(x1,y1,x2,y2,playGrid[gx][gy].containedDiscs[i], bline);
-		playGrid[gx][gy].noDiscs -= 1;
-		}
-
-	    }
-	}
-}
-
-void MyPanZoomWindow::DeleteIntersectedDiscs(int x1,int y1,int x2,int y2,Disc * containedDiscs, bool bline)
-    {
-    int dy=y2-y1;
-    int dx=x2-x1;
-    float m= (float)dy/(float)dx;
-    float dist;
-	//Calculate the distance between the center of the disc and the line
-	dist = abs(dy*(containedDiscs->x - x1) - dx*(containedDiscs->y - y1))/sqrt((float)(dx*dx) + (dy*dy));	
-
-	if((dist-disc_radius)<=0 )	   //Disc Intersects the line
-	    {
-	    containedDiscs->x=0;
-	    containedDiscs->y=0;
-	    }
-	else
-	    {
-	    float f = m*(containedDiscs->x - x1) - (containedDiscs->y - y1);
-	    if(m>0)				    //if slope is positive
-		{
-		if(!bline)
-		    f=f*-1;
-		if( f < 0 )			    //Discs lies within the path rectangle
-		    {
-		    containedDiscs->x=0;
-		    containedDiscs->y=0;
-		    }
-		}
-	    if(m<0)				    //if slope is negative
-		{
-		if(bline)
-		    f=f*-1;
-		if( f > 0 )			    //Discs lies within the path rectangle
-		    {
-		    containedDiscs->x=0;
-		    containedDiscs->y=0;
-		    }
-		}
-	    }
-    }
-
 /**
 \brief Drag the dot around.
 */
 void MyPanZoomWindow::ZJW_mouse(int button, int state, int x, int y)
     {
 	int mouse[2]={x,y};
-	float tempx,tempy;
 	float mouseWorld[2];
 	mouseCoordinatesToWorldCoordinatesPoint(mouse,mouseWorld);
 	if(firstClick==true)
@@ -854,11 +897,9 @@ void MyPanZoomWindow::ZJW_mouse(int button, int state, int x, int y)
 	    firstClick=false;
 	    if(firstSelect==false)
 		{
-	    tempx=mouseWorld[0] - (int)mouseWorld[0] % cell_width;
-	    tempy=mouseWorld[1] - (int)mouseWorld[1] % cell_height;
 	    firstSelect=true;
-	    selectedRect1x=tempx/1000;
-	    selectedRect1y=tempy/1000;    
+	    selectedRect1x=collider.grid().cellColumn((float)mouseWorld[0]);
+	    selectedRect1y=collider.grid().cellRow((float)mouseWorld[1]);    
 		}
 	    }
 	    }
@@ -880,11 +921,9 @@ void MyPanZoomWindow::ZJW_mouse(int button, int state, int x, int y)
 	    {
 	    if(secondSelect==false)
 		{
-	    tempx=mouseWorld[0] - (int)mouseWorld[0] % cell_width;
-	    tempy=mouseWorld[1] - (int)mouseWorld[1] % cell_height;
 	    secondSelect=true;
-	    selectedRect2x=tempx/1000;
-	    selectedRect2y=tempy/1000;    
+	    selectedRect2x=collider.grid().cellColumn((float)mouseWorld[0]);
+	    selectedRect2y=collider.grid().cellRow((float)mouseWorld[1]);    
 		}
 	    else
 		secondSelect=false;
@@ -915,6 +954,54 @@ void MyPanZoomWindow::ZJW_motion(int gx, int gy)
     }
 
 
+/**
+\brief 'ParseScene' overrides parts of 'scene' and 'options' with any of the following
+command line options:
+
+    -discs N        number of discs
+    -radius R       disc radius
+    -maxradius R    largest disc radius; radii are spread from -radius to R
+    -cell S         grid cell size (0 chooses one automatically)
+    -field W H      play field width and height
+    -index NAME     spatial index: grid, quadtree or bvh
+    -zorder         renumber the discs in Z-order for faster queries
+*/
+static void ParseScene (int argc, char** argv, SceneDescription& scene, DemoOptions& options)
+    {
+    for (int i=1;i<argc;i++)
+	{
+	if (!strcmp(argv[i],"-discs") && i+1<argc)
+	    scene.discCount = atoi(argv[++i]);
+	else if (!strcmp(argv[i],"-radius") && i+1<argc)
+	    scene.discRadius = atoi(argv[++i]);
+	else if (!strcmp(argv[i],"-maxradius") && i+1<argc)
+	    scene.maxDiscRadius = atoi(argv[++i]);
+	else if (!strcmp(argv[i],"-cell") && i+1<argc)
+	    scene.cellSize = atoi(argv[++i]);
+	else if (!strcmp(argv[i],"-field") && i+2<argc)
+	    {
+	    scene.field[1][0] = scene.field[0][0] + (float)atof(argv[++i]);
+	    scene.field[1][1] = scene.field[0][1] + (float)atof(argv[++i]);
+	    }
+	else if (!strcmp(argv[i],"-index") && i+1<argc)
+	    {
+	    ++i;
+	    if (!strcmp(argv[i],"grid"))
+		options.backend = SPATIAL_GRID;
+	    else if (!strcmp(argv[i],"quadtree"))
+		options.backend = SPATIAL_QUADTREE;
+	    else if (!strcmp(argv[i],"bvh"))
+		options.backend = SPATIAL_BVH;
+	    else
+		cout << "ignoring unknown index: " << argv[i] << endl;
+	    }
+	else if (!strcmp(argv[i],"-zorder"))
+	    options.sortDiscs = true;
+	else
+	    cout << "ignoring unknown option: " << argv[i] << endl;
+	}
+    }
+
 /**
 \brief 'main' is the standard C/C++ main function where execution starts
 */
@@ -922,12 +1009,18 @@ int main (int argc, char** argv)
     {   
     /* Initialize GLUT library */
     glutInit(&argc, argv);
+
+    /* read the scene description (glutInit has already removed the GLUT options) */
+    SceneDescription scene = DEFAULT_SCENE;
+    DemoOptions options = DEFAULT_OPTIONS;
+    ParseScene(argc, argv, scene, options);
+    ::panZoomWindow = new MyPanZoomWindow(scene, options);
     
     /* create window */    
     glutInitDisplayMode(GLUT_RGB|GLUT_DOUBLE); 
     glutInitWindowPosition(100,100);
     glutInitWindowSize(500, 500);
-    ::panZoomWindow.glutCreateWindow("PanZoom Window Disc Collider");
+    ::panZoomWindow->glutCreateWindow("PanZoom Window Disc Collider");
 
     /** init ITCS4120::OpenGLTrainer classes */
     ITCS4120::OpenGLTrainer::Framebuffer::init();        